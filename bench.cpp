@@ -0,0 +1,479 @@
+// Local benchmark suite for gold.cpp, not a submission.
+// build: g++ -std=c++17 -O2 -o bench bench.cpp
+//        add -DGOLD_LOCAL -pthread to also time what only the local build of gold.cpp has
+//
+// bench [--filter text] [--seed n] [--json out.json] [--compare baseline.json] [--threshold pct]
+//
+// Every benchmark runs on seeded random inputs, warms up, then times K_BENCH_SAMPLES
+// samples of many calls each. Samples further than 3 MADs from the median are dropped
+// before averaging. --compare reads an earlier --json file and exits non-zero when a
+// benchmark got slower than it by more than the threshold (10% by default).
+
+#include "race.h"
+
+#include <climits>
+#include <cstring>
+#include <sstream>
+
+constexpr int K_BENCH_SAMPLES = 25;
+constexpr double K_BENCH_SAMPLE_SECONDS = 0.002;
+constexpr double K_BENCH_WARMUP_SECONDS = 0.02;
+constexpr int K_BENCH_TRACKS = 16;
+constexpr int K_BENCH_STATES = 256;
+constexpr int K_BENCH_VECTORS = 1024;
+constexpr int K_BENCH_INPUT_TURNS = 1 << 14;
+constexpr int K_BENCH_TURNS = 200;
+constexpr int K_BENCH_TRAJECTORIES = 2000;
+
+//stops the compiler from dropping a result nobody reads
+template<typename T>
+void KeepAlive(const T& value) { asm volatile("" : : "r"(&value) : "memory"); }
+
+double Seconds(chrono::steady_clock::time_point from)
+{
+    return chrono::duration<double>(chrono::steady_clock::now() - from).count();
+}
+
+struct BenchResult
+{
+    string name;
+    double meanNs;
+    double medianNs;
+    double minNs;
+    int kept;
+};
+
+struct BenchMetric
+{
+    string name;
+    double value;
+};
+
+struct BenchSuite
+{
+    string filter;
+    vector<BenchResult> results;
+    vector<BenchMetric> metrics;
+
+    bool Selected(const char* name) const { return filter.empty() || strstr(name, filter.c_str()) != nullptr; }
+
+    // Times body(i) for i = 0, 1, 2... setup() runs untimed before every sample, for
+    // benchmarks that consume their inputs; maxCalls bounds a sample for those too.
+    template<typename Setup, typename Body>
+    void Run(const char* name, Setup setup, Body body, long maxCalls = LONG_MAX)
+    {
+        if(!Selected(name)) return;
+
+        auto TimeSample = [&](long calls)
+        {
+            setup();
+            auto start = chrono::steady_clock::now();
+            for(long i=0; i < calls; ++i) body(i);
+            return Seconds(start);
+        };
+
+        //warm up while doubling the calls until one sample is long enough to time
+        long calls = 1;
+        auto warmup = chrono::steady_clock::now();
+        for(;;)
+        {
+            double elapsed = TimeSample(calls);
+            if(elapsed < K_BENCH_SAMPLE_SECONDS && calls * 2 <= maxCalls) calls *= 2;
+            else if(Seconds(warmup) >= K_BENCH_WARMUP_SECONDS) break;
+        }
+
+        vector<double> ns;
+        for(int s=0; s < K_BENCH_SAMPLES; ++s)
+        {
+            ns.push_back(TimeSample(calls) * 1e9 / calls);
+        }
+
+        sort(ns.begin(), ns.end());
+        double median = ns[ns.size() / 2];
+        vector<double> deviations;
+        for(double x : ns) deviations.push_back(abs(x - median));
+        sort(deviations.begin(), deviations.end());
+        double mad = deviations[deviations.size() / 2] * 1.4826;
+
+        double sum = 0.0;
+        int kept = 0;
+        for(double x : ns)
+        {
+            if(mad > 0.0 && abs(x - median) > 3.0 * mad) continue;
+            sum += x;
+            kept++;
+        }
+
+        results.push_back({name, sum / kept, median, ns.front(), kept});
+        printf("%-36s %12.1f ns  (median %.1f, min %.1f, %d/%d samples)\n", name, sum / kept, median, ns.front(), kept, K_BENCH_SAMPLES);
+    }
+
+    template<typename Body>
+    void Run(const char* name, Body body) { Run(name, []() {}, body); }
+
+    void Metric(const char* name, double value)
+    {
+        metrics.push_back({name, value});
+        printf("%-36s %12.4f\n", name, value);
+    }
+
+    // One benchmark or metric object per line, which is also what Compare reads back
+    bool WriteJson(const char* path, uint32_t seed) const
+    {
+        FILE* file = fopen(path, "w");
+        if(!file) return false;
+        fprintf(file, "{\n  \"seed\": %u,\n  \"benchmarks\": [\n", seed);
+        for(size_t i=0; i < results.size(); ++i)
+        {
+            const BenchResult& r = results[i];
+            fprintf(file, "    {\"name\": \"%s\", \"ns_per_call\": %.3f, \"median_ns\": %.3f, \"min_ns\": %.3f, \"samples\": %d, \"kept\": %d}%s\n",
+                r.name.c_str(), r.meanNs, r.medianNs, r.minNs, K_BENCH_SAMPLES, r.kept, (i + 1 < results.size()) ? "," : "");
+        }
+        fprintf(file, "  ],\n  \"metrics\": [\n");
+        for(size_t i=0; i < metrics.size(); ++i)
+        {
+            fprintf(file, "    {\"name\": \"%s\", \"value\": %.6f}%s\n", metrics[i].name.c_str(), metrics[i].value, (i + 1 < metrics.size()) ? "," : "");
+        }
+        fprintf(file, "  ]\n}\n");
+        fclose(file);
+        return true;
+    }
+
+    //number of benchmarks slower than the baseline by more than threshold percent, -1 without a baseline
+    int Compare(const char* path, double threshold) const
+    {
+        FILE* file = fopen(path, "r");
+        if(!file)
+        {
+            fprintf(stderr, "cannot read %s\n", path);
+            return -1;
+        }
+
+        int regressions = 0;
+        char line[512];
+        printf("\ncompared to %s (threshold %.1f%%)\n", path, threshold);
+        while(fgets(line, sizeof(line), file))
+        {
+            char name[128];
+            double baseline;
+            if(sscanf(line, " {\"name\": \"%127[^\"]\", \"ns_per_call\": %lf", name, &baseline) != 2) continue;
+            for(const BenchResult& r : results)
+            {
+                if(r.name != name) continue;
+                double change = 100.0 * (r.meanNs - baseline) / baseline;
+                bool regressed = change > threshold;
+                regressions += regressed;
+                printf("%-36s %+8.1f%%%s\n", name, change, regressed ? "  REGRESSION" : "");
+            }
+        }
+        fclose(file);
+        return regressions;
+    }
+};
+
+// Seeded inputs shared by the benchmarks: game states on a few optimized tracks,
+// loose vectors and a long stream of synthetic turn input
+struct BenchInputs
+{
+    vector<GameState> states;
+    vector<GameState> contacts; //both player pods about to be hit, the most rollouts a shield decision takes
+    Vec2 a[K_BENCH_VECTORS];
+    Vec2 b[K_BENCH_VECTORS];
+    float angles[K_BENCH_VECTORS];
+#ifdef GOLD_LOCAL
+    float features[K_BENCH_VECTORS][K_NET_INPUTS];
+#endif
+    PodState pods[K_BENCH_STATES][K_TOTAL_SHIPCOUNT];
+    PodAction actions[K_BENCH_STATES][K_TOTAL_SHIPCOUNT];
+    string turnText;
+
+    explicit BenchInputs(uint32_t seed)
+    {
+        mt19937 rng(seed);
+        uniform_real_distribution<float> px(0.0f, K_MAP_WIDTH), py(0.0f, K_MAP_HEIGHT), v(-600.0f, 600.0f), deg(0.0f, 360.0f), unit(-1.0f, 1.0f);
+
+        for(int i=0; i < K_BENCH_VECTORS; ++i)
+        {
+            a[i] = {px(rng), py(rng)};
+            b[i] = {v(rng), v(rng)};
+            angles[i] = deg(rng) * K_DEG_TO_RAD;
+#ifdef GOLD_LOCAL
+            std::fill(features[i], features[i] + K_NET_INPUTS, 0.0f);
+            for(int f=0; f < 8; ++f) features[i][f] = unit(rng);
+#endif
+        }
+
+        vector<GameState> tracks(K_BENCH_TRACKS);
+        for(GameState& gs : tracks)
+        {
+            Track track = RandomTrack(rng);
+            gs = {};
+            gs.lapCount = track.lapCount;
+            gs.checkpointCount = track.checkpointCount;
+            std::copy(track.checkpoints, track.checkpoints + track.checkpointCount, gs.checkpoints);
+            gs.InitializeTrack();
+        }
+
+        states.resize(K_BENCH_STATES);
+        for(int s=0; s < K_BENCH_STATES; ++s)
+        {
+            GameState& gs = states[s];
+            gs = tracks[s % K_BENCH_TRACKS];
+            for(int i=0; i < K_TOTAL_SHIPCOUNT; ++i)
+            {
+                int checkpoint = uniform_int_distribution<int>(0, gs.checkpointCount - 1)(rng);
+                gs.UpdateShip(i, {roundf(px(rng)), roundf(py(rng))}, {truncf(v(rng)), truncf(v(rng))}, roundf(deg(rng)), checkpoint);
+                pods[s][i] = gs.ships[i].State();
+                actions[s][i] = {{px(rng), py(rng)}, K_MAX_THRUST * (unit(rng) + 1.0f) * 0.5f, unit(rng) > 0.9f, unit(rng) > 0.9f};
+            }
+            DecideTurn(gs); //so the per pod evaluations start from a decided turn
+        }
+
+        contacts.assign(states.begin(), states.begin() + K_BENCH_TRACKS);
+        for(GameState& gs : contacts)
+        {
+            for(int i=0; i < K_PLAYERCOUNT; ++i)
+            {
+                Ship& ship = gs.Player(i);
+                gs.UpdateShip(i + K_PLAYERCOUNT, ship.pos + Vec2{900.0f, 0.0f}, {-300.0f, 0.0f}, 180.0f, gs.Enemy(i).nextCheckpointIdx);
+            }
+            DecideTurn(gs);
+        }
+
+        //the reader's track has at least 3 checkpoints
+        ostringstream text;
+        for(int t=0; t < K_BENCH_INPUT_TURNS; ++t)
+        {
+            for(int i=0; i < K_TOTAL_SHIPCOUNT; ++i)
+            {
+                text << (int)px(rng) << " " << (int)py(rng) << " " << (int)v(rng) << " " << (int)v(rng) << " "
+                     << (int)deg(rng) << " " << uniform_int_distribution<int>(0, 2)(rng) << "\n";
+            }
+        }
+        turnText = text.str();
+    }
+
+    GameState& State(long i) { return states[i % K_BENCH_STATES]; }
+};
+
+void BenchVec2(BenchSuite& suite, BenchInputs& in)
+{
+    constexpr int mask = K_BENCH_VECTORS - 1;
+    suite.Run("vec2/add", [&](long i) { KeepAlive(in.a[i & mask] + in.b[i & mask]); });
+    suite.Run("vec2/sub", [&](long i) { KeepAlive(in.a[i & mask] - in.b[i & mask]); });
+    suite.Run("vec2/scale", [&](long i) { KeepAlive(in.a[i & mask] * in.angles[i & mask]); });
+    suite.Run("vec2/dot", [&](long i) { KeepAlive(in.a[i & mask].Dot(in.b[i & mask])); });
+    suite.Run("vec2/length", [&](long i) { KeepAlive(in.b[i & mask].Length()); });
+    suite.Run("vec2/normalized", [&](long i) { KeepAlive(in.b[i & mask].Normalized()); });
+    suite.Run("vec2/rotate", [&](long i) { KeepAlive(in.b[i & mask].Rotate(in.angles[i & mask])); });
+    suite.Run("vec2/to_angle", [&](long i) { KeepAlive(in.b[i & mask].ToAngle()); });
+}
+
+void BenchDecisions(BenchSuite& suite, BenchInputs& in)
+{
+    GameState reader = in.states[0];
+    istringstream input;
+    streambuf* stdinBuf = cin.rdbuf(input.rdbuf());
+    suite.Run("gamestate/read_input", [&]() { input.clear(); input.str(in.turnText); }, [&](long) { reader.ReadInput(); }, K_BENCH_INPUT_TURNS);
+    cin.rdbuf(stdinBuf);
+
+    suite.Run("gamestate/find_best_enemy", [&](long i) { KeepAlive(&in.State(i).FindBestEnemy()); });
+    suite.Run("gamestate/initialize_track", [&](long i) { in.State(i).InitializeTrack(); });
+
+    suite.Run("evaluate/target_coord/runner", [&](long i) { GameState& gs = in.State(i); EvaluateTargetCoord(gs, gs.Player(0)); });
+    suite.Run("evaluate/target_coord/bumper", [&](long i) { GameState& gs = in.State(i); EvaluateTargetCoord(gs, gs.Player(1)); });
+    suite.Run("evaluate/thrust/runner", [&](long i) { GameState& gs = in.State(i); EvaluateThrust(gs, gs.Player(0)); });
+    suite.Run("evaluate/thrust/bumper", [&](long i) { GameState& gs = in.State(i); EvaluateThrust(gs, gs.Player(1)); });
+    suite.Run("evaluate/should_boost", [&](long i) { GameState& gs = in.State(i); EvaluateShouldBoost(gs, gs.Player(0)); });
+    //the rollouts live on the turn's arena, DecideTurn would reset it
+    suite.Run("evaluate/should_shield", [&](long i) { GameState& gs = in.State(i); gs.arena.Reset(); EvaluateShouldShield(gs); });
+    suite.Run("evaluate/should_shield/contact", [&](long i) { GameState& gs = in.contacts[i % K_BENCH_TRACKS]; gs.arena.Reset(); EvaluateShouldShield(gs); });
+    suite.Run("decide/turn", [&](long i) { DecideTurn(in.State(i)); });
+}
+
+void BenchSimulation(BenchSuite& suite, BenchInputs& in)
+{
+    suite.Run("physics/simulate_move", [&](long i)
+    {
+        PodState pod = in.pods[i % K_BENCH_STATES][0];
+        SimulateMove(pod, in.a[i & (K_BENCH_VECTORS - 1)], K_MAX_THRUST);
+        SimulateEndTurn(pod);
+        KeepAlive(pod);
+    });
+
+    FixedPodBatch batch;
+    alignas(32) int32_t rotation[FixedPodBatch::K_LANES], thrust[FixedPodBatch::K_LANES];
+    for(int l=0; l < FixedPodBatch::K_LANES; ++l)
+    {
+        batch.Set(l, in.pods[l][0]);
+        rotation[l] = FixedPodBatch::ToFixedAngle(in.angles[l] * K_RAD_TO_DEG / 20.0f);
+        thrust[l] = (int32_t)K_MAX_THRUST;
+    }
+    suite.Run("physics/fixed_step_8_pods", [&](long) { batch.Step(rotation, thrust); KeepAlive(batch); });
+
+    suite.Run("physics/simulate_turn_4_pods", [&](long i)
+    {
+        const GameState& gs = in.State(i);
+        PodState pods[K_TOTAL_SHIPCOUNT];
+        std::copy(in.pods[i % K_BENCH_STATES], in.pods[i % K_BENCH_STATES] + K_TOTAL_SHIPCOUNT, pods);
+        SimulateTurn(pods, in.actions[i % K_BENCH_STATES], K_TOTAL_SHIPCOUNT, gs.checkpoints, gs.checkpointCount);
+        KeepAlive(pods);
+    });
+
+    for(int k=0; k < PolicyKindCount; ++k)
+    {
+        string name = string("policy/") + K_POLICY_NAMES[k];
+        suite.Run(name.c_str(), [&](long i)
+        {
+            PodAction actions[K_PLAYERCOUNT];
+            PolicyActions((PolicyKind)k, in.State(i), in.pods[i % K_BENCH_STATES], 1, actions);
+            KeepAlive(actions);
+        });
+    }
+
+#ifdef GOLD_LOCAL
+    OpponentModel opponents;
+    suite.Run("opponents/observe", [&](long i) { opponents.Observe(in.State(i)); });
+#endif
+
+    EnemyOccupancy occupancy;
+    Arena arena;
+    arena.Reserve(K_ARENA_BYTES);
+    suite.Run("occupancy/update", [&](long i)
+    {
+        const GameState& gs = in.State(i);
+        arena.Reset();
+        occupancy.Update(in.pods[i % K_BENCH_STATES] + K_PLAYERCOUNT, K_ENEMYCOUNT, gs.checkpoints, arena);
+    });
+    suite.Run("occupancy/query", [&](long i) { KeepAlive(occupancy.At(i % K_OCCUPANCY_TURNS, in.a[i & (K_BENCH_VECTORS - 1)])); });
+
+#ifdef GOLD_LOCAL
+    suite.Run("policy_net/forward", [&](long i) { KeepAlive(RunPolicyNet(in.features[i & (K_BENCH_VECTORS - 1)])); });
+#endif
+}
+
+// Referee movement in double precision, the ground truth both movement models are measured against
+struct RefereePod
+{
+    double x, y, vx, vy, angle;
+
+    void Step(double tx, double ty, int thrust)
+    {
+        double desired = atan2(ty - y, tx - x) * 180.0 / M_PI;
+        if(desired < 0.0) desired += 360.0;
+        double diff = desired - angle;
+        if(diff > 180.0) diff -= 360.0;
+        if(diff < -180.0) diff += 360.0;
+        angle += std::clamp(diff, -18.0, 18.0);
+        if(angle < 0.0) angle += 360.0;
+        if(angle >= 360.0) angle -= 360.0;
+
+        vx += cos(angle * M_PI / 180.0) * thrust;
+        vy += sin(angle * M_PI / 180.0) * thrust;
+        x = floor(x + vx + 0.5);
+        y = floor(y + vy + 0.5);
+        vx = trunc(vx * 0.85);
+        vy = trunc(vy * 0.85);
+    }
+};
+
+// Prediction error of SimulateMove and the FixedPodBatch kernel against the referee: one
+// step from the exact referee state isolates each model's own error, whole
+// trajectories show how quickly it snowballs
+void MeasurePhysicsError(BenchSuite& suite, uint32_t seed)
+{
+    if(!suite.Selected("physics/error")) return;
+
+    constexpr int lanes = FixedPodBatch::K_LANES;
+    mt19937 rng(seed);
+    uniform_int_distribution<int> px(0, K_MAP_WIDTH), py(0, K_MAP_HEIGHT), v(-600, 600), deg(0, 359), thrustDist(0, 100);
+
+    double floatErr = 0.0, fixedErr = 0.0;
+    long floatExact = 0, fixedExact = 0, floatStepExact = 0, fixedStepExact = 0;
+    for(int i=0; i < K_BENCH_TRAJECTORIES; ++i)
+    {
+        PodState start = {{(float)px(rng), (float)py(rng)}, {(float)v(rng), (float)v(rng)}, (float)deg(rng), 0, 0};
+        RefereePod ref = {start.pos.x, start.pos.y, start.velocity.x, start.velocity.y, start.angle};
+        PodState pod = start;
+        //every lane steps the same pod, only lane 0 is compared
+        FixedPodBatch batch;
+        for(int l=0; l < lanes; ++l) batch.Set(l, start);
+
+        for(int t=0; t < K_BENCH_TURNS; ++t)
+        {
+            Vec2 target = {(float)px(rng), (float)py(rng)};
+            int32_t thrust[lanes];
+            std::fill(thrust, thrust + lanes, thrustDist(rng));
+
+            PodState stepPod = {{(float)ref.x, (float)ref.y}, {(float)ref.vx, (float)ref.vy}, (float)ref.angle, 0, 0};
+            FixedPodBatch stepBatch;
+            for(int l=0; l < lanes; ++l)
+            {
+                stepBatch.Set(l, stepPod);
+                stepBatch.angle[l] = FixedPodBatch::ToFixedAngle(ref.angle);
+            }
+
+            ref.Step(target.x, target.y, thrust[0]);
+
+            SimulateMove(stepPod, target, (float)thrust[0]);
+            SimulateEndTurn(stepPod);
+            int32_t stepRotation[lanes];
+            for(int l=0; l < lanes; ++l) stepRotation[l] = stepBatch.Aim(l, target);
+            stepBatch.Step(stepRotation, thrust);
+            floatStepExact += (stepPod.pos.x == ref.x && stepPod.pos.y == ref.y && stepPod.velocity.x == ref.vx && stepPod.velocity.y == ref.vy);
+            fixedStepExact += (stepBatch.x[0] == ref.x && stepBatch.y[0] == ref.y && stepBatch.vx[0] == ref.vx && stepBatch.vy[0] == ref.vy);
+
+            SimulateMove(pod, target, (float)thrust[0]);
+            SimulateEndTurn(pod);
+            int32_t rotation[lanes];
+            for(int l=0; l < lanes; ++l) rotation[l] = batch.Aim(l, target);
+            batch.Step(rotation, thrust);
+
+            double ef = hypot(pod.pos.x - ref.x, pod.pos.y - ref.y);
+            double ex = hypot(batch.x[0] - ref.x, batch.y[0] - ref.y);
+            floatErr += ef;
+            fixedErr += ex;
+            floatExact += (ef == 0.0);
+            fixedExact += (ex == 0.0);
+        }
+    }
+
+    double samples = (double)K_BENCH_TRAJECTORIES * K_BENCH_TURNS;
+    suite.Metric("physics/error/float_step_mismatch_pct", 100.0 - 100.0 * floatStepExact / samples);
+    suite.Metric("physics/error/fixed_step_mismatch_pct", 100.0 - 100.0 * fixedStepExact / samples);
+    suite.Metric("physics/error/float_trajectory_mean", floatErr / samples);
+    suite.Metric("physics/error/fixed_trajectory_mean", fixedErr / samples);
+    suite.Metric("physics/error/float_trajectory_exact_pct", 100.0 * floatExact / samples);
+    suite.Metric("physics/error/fixed_trajectory_exact_pct", 100.0 * fixedExact / samples);
+}
+
+int main(int argc, char** argv)
+{
+    BenchSuite suite;
+    uint32_t seed = 1234;
+    const char* jsonPath = nullptr;
+    const char* comparePath = nullptr;
+    double threshold = 10.0;
+
+    for(int i=1; i + 1 < argc; i += 2)
+    {
+        if(strcmp(argv[i], "--filter") == 0) suite.filter = argv[i+1];
+        else if(strcmp(argv[i], "--seed") == 0) seed = (uint32_t)atoi(argv[i+1]);
+        else if(strcmp(argv[i], "--json") == 0) jsonPath = argv[i+1];
+        else if(strcmp(argv[i], "--compare") == 0) comparePath = argv[i+1];
+        else if(strcmp(argv[i], "--threshold") == 0) threshold = atof(argv[i+1]);
+    }
+
+    static BenchInputs inputs(seed);
+    BenchVec2(suite, inputs);
+    BenchDecisions(suite, inputs);
+    BenchSimulation(suite, inputs);
+    MeasurePhysicsError(suite, seed);
+
+    if(jsonPath && !suite.WriteJson(jsonPath, seed))
+    {
+        fprintf(stderr, "cannot write %s\n", jsonPath);
+        return 1;
+    }
+    return (comparePath && suite.Compare(comparePath, threshold) != 0) ? 1 : 0;
+}
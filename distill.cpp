@@ -0,0 +1,398 @@
+// Distills the racing line controller into the policy/value network of gold.cpp, not a submission.
+// build: g++ -std=c++17 -O2 -pthread -DGOLD_LOCAL -o distill distill.cpp
+//
+// distill [tracks] [epochs] [seed] > weights.txt
+//
+// Flies the racing line controller alone over random tracks and records, for every turn
+// and a few perturbed copies of it, the network features and the controller's answer:
+// rotation, thrust and the turns it still needs to the next checkpoint. A float copy of
+// the 8-32-32-3 network is fitted to them with Adam, then quantized to the int8 weights
+// and int32 biases RunPolicyNet reads. The weight block is printed to stdout in gold.cpp's
+// layout, ready to replace K_NET_SHIFT1 through K_NET_B3. Progress and a comparison of
+// the quantized network against the controller on fresh tracks go to stderr.
+//
+// The defaults reproduce the weights in gold.cpp, as long as OptimizeRacingLines finishes
+// its sweeps within K_DISTILL_LINES_SECONDS: a racing line cut short by its deadline
+// changes the samples and everything trained from them.
+
+#include "race.h"
+
+#include <cstring>
+
+#ifndef GOLD_LOCAL
+#error distill needs the network of the GOLD_LOCAL build, compile with -DGOLD_LOCAL -pthread
+#endif
+
+constexpr int K_DISTILL_TRACKS = 1500;
+constexpr int K_DISTILL_EPOCHS = 30;
+constexpr uint32_t K_DISTILL_SEED = 42;
+constexpr int K_DISTILL_MIN_CHECKPOINTS = 3; //the harness tracks when the weights were made
+constexpr int K_DISTILL_TURNS = 300; //recorded per track
+constexpr int K_DISTILL_PERTURBED = 2; //extra samples per turn, off the controller's own path
+constexpr int K_DISTILL_BATCH = 64;
+constexpr float K_DISTILL_LEARNING_RATE = 1e-3f;
+constexpr float K_DISTILL_LINES_SECONDS = 5.0f; //racing line search per track, enough to finish every sweep
+constexpr int K_DISTILL_TEST_TRACKS = 100;
+constexpr uint32_t K_DISTILL_TEST_SEED = 777;
+constexpr int K_DISTILL_TEST_TURNS = 600;
+constexpr int K_DISTILL_VALUE_TURNS = 50; //the value target gives up after this many turns
+constexpr float K_DISTILL_VALUE_SCALE = 10.0f; //turns per unit of the value output, as RunPolicyNet reads it
+
+constexpr int K_FEATURES = 8; //PolicyFeatures fills the first 8 of K_NET_INPUTS
+const float K_OUTPUT_WEIGHTS[K_NET_OUTPUTS] = {1.0f, 1.0f, 0.3f}; //the value matters less than the policy
+
+struct Sample
+{
+    float features[K_NET_INPUTS];
+    float target[K_NET_OUTPUTS];
+};
+
+//a track with its racing lines, as the bot would have it after the first turn
+GameState TrackState(mt19937& rng)
+{
+    Track track = RandomTrack(rng, uniform_int_distribution<int>(K_DISTILL_MIN_CHECKPOINTS, K_MAX_CHECKPOINTS)(rng));
+    GameState gs;
+    gs.lapCount = track.lapCount;
+    gs.checkpointCount = track.checkpointCount;
+    std::copy(track.checkpoints, track.checkpoints + track.checkpointCount, gs.checkpoints);
+    gs.OptimizeRacingLines(chrono::steady_clock::now() + chrono::microseconds((int)(K_DISTILL_LINES_SECONDS * 1e6f)));
+    return gs;
+}
+
+//one turn of the controller, true if the pod crossed its checkpoint
+bool ControllerStep(const GameState& gs, PodState& pod)
+{
+    Vec2 target;
+    gs.RacingLineControl(pod, target);
+    Vec2 from = pod.pos;
+    SimulateMove(pod, target, RacingThrust(pod, target));
+    bool crossed = SegmentHitsCircle(from, pod.pos, gs.checkpoints[pod.nextCheckpointIdx], K_CHECKPOINT_RADIUS);
+    if(crossed) pod.nextCheckpointIdx = (pod.nextCheckpointIdx+1)%gs.checkpointCount;
+    SimulateEndTurn(pod);
+    return crossed;
+}
+
+int TurnsToCheckpoint(const GameState& gs, PodState pod)
+{
+    for(int t=1; t <= K_DISTILL_VALUE_TURNS; ++t)
+    {
+        if(ControllerStep(gs, pod)) return t;
+    }
+    return K_DISTILL_VALUE_TURNS;
+}
+
+Sample MakeSample(const GameState& gs, const PodState& pod)
+{
+    Sample sample;
+    PolicyFeatures(pod, gs.checkpoints[pod.nextCheckpointIdx], gs.checkpoints[(pod.nextCheckpointIdx+1)%gs.checkpointCount], sample.features);
+
+    Vec2 target;
+    gs.RacingLineControl(pod, target);
+    float desired = (target - pod.pos).ToAngle() * K_RAD_TO_DEG;
+    sample.target[0] = std::clamp(AngleDiff(pod.angle, desired) / K_MAX_ROTATION_DEG, -1.0f, 1.0f);
+    sample.target[1] = RacingThrust(pod, target) / K_MAX_THRUST;
+    sample.target[2] = TurnsToCheckpoint(gs, pod) / K_DISTILL_VALUE_SCALE;
+    return sample;
+}
+
+vector<Sample> Generate(mt19937& rng, int tracks)
+{
+    uniform_real_distribution<float> speedNoise(-200.0f, 200.0f), angleNoise(-60.0f, 60.0f), posNoise(-500.0f, 500.0f);
+    vector<Sample> samples;
+    for(int k=0; k < tracks; ++k)
+    {
+        GameState gs = TrackState(rng);
+        Vec2 firstLeg = gs.checkpoints[1] - gs.checkpoints[0];
+        PodState pod = {gs.checkpoints[0], {0.0f, 0.0f}, NormalizeAngle(firstLeg.ToAngle() * K_RAD_TO_DEG), 1, 0};
+        for(int t=0; t < K_DISTILL_TURNS; ++t)
+        {
+            samples.push_back(MakeSample(gs, pod));
+            for(int p=0; p < K_DISTILL_PERTURBED; ++p)
+            {
+                PodState off = pod;
+                off.velocity = off.velocity + Vec2{speedNoise(rng), speedNoise(rng)};
+                off.angle = NormalizeAngle(off.angle + angleNoise(rng));
+                off.pos = off.pos + Vec2{posNoise(rng), posNoise(rng)};
+                samples.push_back(MakeSample(gs, off));
+            }
+            ControllerStep(gs, pod);
+        }
+    }
+    return samples;
+}
+
+// The float network being fitted, laid out like the quantized one: weights[j][i] feeds
+// input i into unit j.
+struct FloatNet
+{
+    static constexpr int K_PARAMS = 6;
+
+    float w1[K_NET_HIDDEN][K_FEATURES];
+    float b1[K_NET_HIDDEN];
+    float w2[K_NET_HIDDEN][K_NET_HIDDEN];
+    float b2[K_NET_HIDDEN];
+    float w3[K_NET_OUTPUTS][K_NET_HIDDEN];
+    float b3[K_NET_OUTPUTS];
+
+    float* Params(int p) { float* params[K_PARAMS] = {&w1[0][0], b1, &w2[0][0], b2, &w3[0][0], b3}; return params[p]; }
+    static int Size(int p) { constexpr int sizes[K_PARAMS] = {K_NET_HIDDEN * K_FEATURES, K_NET_HIDDEN, K_NET_HIDDEN * K_NET_HIDDEN, K_NET_HIDDEN, K_NET_OUTPUTS * K_NET_HIDDEN, K_NET_OUTPUTS}; return sizes[p]; }
+
+    //He initialization, zero biases
+    void Initialize(mt19937& rng)
+    {
+        auto Fill = [&](float* w, int count, int fanIn)
+        {
+            //a fresh distribution per weight, it would otherwise hand out its cached pair
+            for(int i=0; i < count; ++i) w[i] = normal_distribution<float>(0.0f, sqrt(2.0f / fanIn))(rng);
+        };
+        Fill(&w1[0][0], K_NET_HIDDEN * K_FEATURES, K_FEATURES);
+        Fill(&w2[0][0], K_NET_HIDDEN * K_NET_HIDDEN, K_NET_HIDDEN);
+        Fill(&w3[0][0], K_NET_OUTPUTS * K_NET_HIDDEN, K_NET_HIDDEN);
+        memset(b1, 0, sizeof(b1));
+        memset(b2, 0, sizeof(b2));
+        memset(b3, 0, sizeof(b3));
+    }
+
+    void Forward(const float* x, float* h1, float* h2, float* out) const
+    {
+        for(int j=0; j < K_NET_HIDDEN; ++j)
+        {
+            float a = b1[j];
+            for(int i=0; i < K_FEATURES; ++i) a += w1[j][i] * x[i];
+            h1[j] = max(a, 0.0f);
+        }
+        for(int j=0; j < K_NET_HIDDEN; ++j)
+        {
+            float a = b2[j];
+            for(int i=0; i < K_NET_HIDDEN; ++i) a += w2[j][i] * h1[i];
+            h2[j] = max(a, 0.0f);
+        }
+        for(int j=0; j < K_NET_OUTPUTS; ++j)
+        {
+            float a = b3[j];
+            for(int i=0; i < K_NET_HIDDEN; ++i) a += w3[j][i] * h2[i];
+            out[j] = a;
+        }
+    }
+
+    //adds the gradient of the weighted squared error of one sample, scaled by 1/batch, to grad
+    float Backward(const Sample& s, float* const* grad, int batch) const
+    {
+        float h1[K_NET_HIDDEN], h2[K_NET_HIDDEN], out[K_NET_OUTPUTS];
+        Forward(s.features, h1, h2, out);
+
+        float loss = 0.0f;
+        float gOut[K_NET_OUTPUTS];
+        for(int j=0; j < K_NET_OUTPUTS; ++j)
+        {
+            float d = out[j] - s.target[j];
+            loss += K_OUTPUT_WEIGHTS[j] * d * d;
+            gOut[j] = 2.0f * K_OUTPUT_WEIGHTS[j] * d / batch;
+        }
+
+        float g2[K_NET_HIDDEN] = {};
+        for(int j=0; j < K_NET_OUTPUTS; ++j)
+        {
+            grad[5][j] += gOut[j];
+            for(int i=0; i < K_NET_HIDDEN; ++i)
+            {
+                grad[4][j * K_NET_HIDDEN + i] += gOut[j] * h2[i];
+                g2[i] += gOut[j] * w3[j][i];
+            }
+        }
+
+        float g1[K_NET_HIDDEN] = {};
+        for(int j=0; j < K_NET_HIDDEN; ++j)
+        {
+            if(h2[j] <= 0.0f) continue;
+            grad[3][j] += g2[j];
+            for(int i=0; i < K_NET_HIDDEN; ++i)
+            {
+                grad[2][j * K_NET_HIDDEN + i] += g2[j] * h1[i];
+                g1[i] += g2[j] * w2[j][i];
+            }
+        }
+
+        for(int j=0; j < K_NET_HIDDEN; ++j)
+        {
+            if(h1[j] <= 0.0f) continue;
+            grad[1][j] += g1[j];
+            for(int i=0; i < K_FEATURES; ++i) grad[0][j * K_FEATURES + i] += g1[j] * s.features[i];
+        }
+        return loss;
+    }
+};
+
+// Minibatch Adam over shuffled samples, the learning rate drops to 30% for the last third
+void Train(FloatNet& net, const vector<Sample>& samples, int epochs, mt19937& rng)
+{
+    constexpr float beta1 = 0.9f, beta2 = 0.999f;
+    vector<float> grad[FloatNet::K_PARAMS], m[FloatNet::K_PARAMS], v[FloatNet::K_PARAMS];
+    float* gradPtr[FloatNet::K_PARAMS];
+    for(int p=0; p < FloatNet::K_PARAMS; ++p)
+    {
+        grad[p].assign(FloatNet::Size(p), 0.0f);
+        m[p].assign(FloatNet::Size(p), 0.0f);
+        v[p].assign(FloatNet::Size(p), 0.0f);
+        gradPtr[p] = grad[p].data();
+    }
+
+    vector<int> order(samples.size());
+    for(size_t i=0; i < order.size(); ++i) order[i] = (int)i;
+
+    float rate = K_DISTILL_LEARNING_RATE;
+    long step = 0;
+    for(int e=0; e < epochs; ++e)
+    {
+        shuffle(order.begin(), order.end(), rng);
+        if(e == epochs * 2 / 3) rate *= 0.3f;
+
+        double loss = 0.0;
+        for(size_t b=0; b + K_DISTILL_BATCH <= order.size(); b += K_DISTILL_BATCH)
+        {
+            for(auto& g : grad) std::fill(g.begin(), g.end(), 0.0f);
+            for(int k=0; k < K_DISTILL_BATCH; ++k) loss += net.Backward(samples[order[b + k]], gradPtr, K_DISTILL_BATCH);
+
+            step++;
+            for(int p=0; p < FloatNet::K_PARAMS; ++p)
+            {
+                float* params = net.Params(p);
+                for(int i=0; i < FloatNet::Size(p); ++i)
+                {
+                    m[p][i] = beta1 * m[p][i] + (1.0f - beta1) * grad[p][i];
+                    v[p][i] = beta2 * v[p][i] + (1.0f - beta2) * grad[p][i] * grad[p][i];
+                    float mHat = m[p][i] / (1.0f - pow(beta1, step));
+                    float vHat = v[p][i] / (1.0f - pow(beta2, step));
+                    params[i] -= rate * mHat / (sqrt(vHat) + 1e-8f);
+                }
+            }
+        }
+        fprintf(stderr, "epoch %d loss %f\n", e, loss / order.size());
+    }
+}
+
+//largest power of two scale, up to 2^12, that keeps the layer's weights within int8
+int WeightShift(const float* w, int count)
+{
+    float largest = 0.0f;
+    for(int i=0; i < count; ++i) largest = max(largest, abs(w[i]));
+    int shift = 0;
+    while(shift < 12 && largest * (1 << (shift + 1)) <= 127.0f) shift++;
+    return shift;
+}
+
+int QuantizeWeight(float w, int shift) { return (int)std::clamp(lroundf(w * (1 << shift)), -127L, 127L); }
+
+//biases land on the accumulator's scale: input fraction bits plus the weight shift
+long QuantizeBias(float b, int shift) { return lround(b * (1 << (K_NET_INPUT_SHIFT + shift))); }
+
+void PrintArray(const char* declaration, const vector<long>& values, int perLine)
+{
+    printf("%s = {\n", declaration);
+    for(size_t i=0; i < values.size(); i += perLine)
+    {
+        printf("    ");
+        for(size_t k=i; k < min(values.size(), i + perLine); ++k)
+        {
+            printf("%ld%s", values[k], (k + 1 < values.size()) ? ((k + 1 < i + perLine) ? ", " : ",") : "");
+        }
+        printf("\n");
+    }
+    printf("};\n");
+}
+
+void PrintWeights(const FloatNet& net)
+{
+    int shift1 = WeightShift(&net.w1[0][0], K_NET_HIDDEN * K_FEATURES);
+    int shift2 = WeightShift(&net.w2[0][0], K_NET_HIDDEN * K_NET_HIDDEN);
+    int shift3 = WeightShift(&net.w3[0][0], K_NET_OUTPUTS * K_NET_HIDDEN);
+
+    vector<long> w1, b1, w2, b2, w3, b3;
+    for(int j=0; j < K_NET_HIDDEN; ++j)
+    {
+        //the padding inputs beyond the features get zero weights
+        for(int i=0; i < K_NET_INPUTS; ++i) w1.push_back((i < K_FEATURES) ? QuantizeWeight(net.w1[j][i], shift1) : 0);
+        b1.push_back(QuantizeBias(net.b1[j], shift1));
+        for(int i=0; i < K_NET_HIDDEN; ++i) w2.push_back(QuantizeWeight(net.w2[j][i], shift2));
+        b2.push_back(QuantizeBias(net.b2[j], shift2));
+    }
+    for(int j=0; j < K_NET_OUTPUTS; ++j)
+    {
+        for(int i=0; i < K_NET_HIDDEN; ++i) w3.push_back(QuantizeWeight(net.w3[j][i], shift3));
+        b3.push_back(QuantizeBias(net.b3[j], shift3));
+    }
+
+    printf("constexpr int K_NET_SHIFT1 = %d;\nconstexpr int K_NET_SHIFT2 = %d;\nconstexpr int K_NET_SHIFT3 = %d;\n", shift1, shift2, shift3);
+    PrintArray("alignas(32) constexpr int8_t K_NET_W1[K_NET_HIDDEN * K_NET_INPUTS]", w1, 16);
+    PrintArray("alignas(32) constexpr int32_t K_NET_B1[K_NET_HIDDEN]", b1, 8);
+    PrintArray("alignas(32) constexpr int8_t K_NET_W2[K_NET_HIDDEN * K_NET_HIDDEN]", w2, 16);
+    PrintArray("alignas(32) constexpr int32_t K_NET_B2[K_NET_HIDDEN]", b2, 8);
+    PrintArray("alignas(32) constexpr int8_t K_NET_W3[K_NET_OUTPUTS * K_NET_HIDDEN]", w3, 16);
+    PrintArray("alignas(32) constexpr int32_t K_NET_B3[K_NET_OUTPUTS]", b3, 8);
+}
+
+// Three laps on fresh tracks with the controller and with the network gold.cpp was built
+// with, the way EvaluateTargetCoord steers by it. Only meaningful once the printed weights
+// are pasted in and this tool is rebuilt.
+void CompareWithController()
+{
+    mt19937 rng(K_DISTILL_TEST_SEED);
+    long controllerTurns = 0, netTurns = 0;
+    int netFailures = 0;
+    for(int k=0; k < K_DISTILL_TEST_TRACKS; ++k)
+    {
+        GameState gs = TrackState(rng);
+        auto Race = [&](bool net)
+        {
+            PodState pod = {gs.checkpoints[0], {0.0f, 0.0f}, -1.0f, 1, 0};
+            int passed = 0;
+            for(int t=1; t <= K_DISTILL_TEST_TURNS; ++t)
+            {
+                if(!net)
+                {
+                    passed += ControllerStep(gs, pod);
+                }
+                else
+                {
+                    PolicyOutput policy = gs.EvaluatePolicy(pod);
+                    Vec2 checkpoint = gs.checkpoints[pod.nextCheckpointIdx];
+                    float heading = (pod.angle < 0.0f) ? (checkpoint - pod.pos).ToAngle() * K_RAD_TO_DEG : pod.angle + policy.rotation;
+                    Vec2 from = pod.pos;
+                    SimulateMove(pod, pod.pos + AngleToDir(heading) * 10000.0f, policy.thrust);
+                    if(SegmentHitsCircle(from, pod.pos, checkpoint, K_CHECKPOINT_RADIUS))
+                    {
+                        pod.nextCheckpointIdx = (pod.nextCheckpointIdx+1)%gs.checkpointCount;
+                        passed++;
+                    }
+                    SimulateEndTurn(pod);
+                }
+                if(passed == K_RACE_LAPS * gs.checkpointCount) return t;
+            }
+            return K_DISTILL_TEST_TURNS;
+        };
+        controllerTurns += Race(false);
+        int turns = Race(true);
+        netTurns += turns;
+        netFailures += (turns == K_DISTILL_TEST_TURNS);
+    }
+    fprintf(stderr, "%d test tracks: controller %ld turns, network %ld turns, %d unfinished\n", K_DISTILL_TEST_TRACKS, controllerTurns, netTurns, netFailures);
+}
+
+int main(int argc, char** argv)
+{
+    int tracks = (argc > 1) ? atoi(argv[1]) : K_DISTILL_TRACKS;
+    int epochs = (argc > 2) ? atoi(argv[2]) : K_DISTILL_EPOCHS;
+    uint32_t seed = (argc > 3) ? (uint32_t)atoi(argv[3]) : K_DISTILL_SEED;
+
+    mt19937 rng(seed);
+    vector<Sample> samples = Generate(rng, tracks);
+    fprintf(stderr, "%zu samples from %d tracks\n", samples.size(), tracks);
+
+    FloatNet net;
+    net.Initialize(rng);
+    Train(net, samples, epochs, rng);
+    PrintWeights(net);
+
+    CompareWithController();
+    return 0;
+}
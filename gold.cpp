@@ -3,6 +3,18 @@
 #include <vector>
 #include <algorithm>
 #include <cmath>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <type_traits>
+#include <immintrin.h>
+#ifdef GOLD_LOCAL
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#endif
 
 using namespace std;
 
@@ -10,12 +22,73 @@ constexpr float K_MAX_THRUST = 100.0f;
 constexpr float K_POD_RADIUS = 400.0f;
 constexpr float K_CHECKPOINT_RADIUS = 600.0f;
 constexpr int K_MAX_CHECKPOINTS = 8;
+constexpr int K_MAP_WIDTH = 16000;
+constexpr int K_MAP_HEIGHT = 9000;
 constexpr float K_DEG_TO_RAD = M_PI / 180.0f;
 constexpr float K_RAD_TO_DEG = 180.0f / M_PI;
 constexpr float K_EPS = 1e-7f;
 constexpr int K_PLAYERCOUNT = 2;
 constexpr int K_ENEMYCOUNT = 2;
 constexpr int K_TOTAL_SHIPCOUNT = K_PLAYERCOUNT + K_ENEMYCOUNT;
+constexpr float K_MAX_ROTATION_DEG = 18.0f;
+constexpr float K_FRICTION = 0.85f;
+constexpr float K_BOOST_THRUST = 650.0f;
+constexpr float K_SHIELD_MASS = 10.0f;
+constexpr int K_SHIELD_COOLDOWN = 3; //turns without thrust after a SHIELD
+constexpr float K_MIN_IMPULSE = 120.0f;
+constexpr int K_FIXED_SHIFT = 18; //fractional bits of velocities within a fixed point step
+constexpr int K_TRIG_SHIFT = 21; //fractional bits of the trig table, thrust * 2^21 still fits int32
+constexpr int K_ANGLE_BITS = 26; //fixed point headings split the full turn in 2^26 steps
+constexpr int K_ANGLE_STEPS = 1 << K_ANGLE_BITS;
+constexpr int K_TRIG_FRAC_BITS = 14; //heading bits interpolated between trig table entries
+constexpr int K_TRIG_ENTRIES = K_ANGLE_STEPS >> K_TRIG_FRAC_BITS;
+#ifdef GOLD_LOCAL
+constexpr int K_NET_INPUTS = 16; //8 features padded to one AVX2 register of int16
+constexpr int K_NET_HIDDEN = 32;
+constexpr int K_NET_OUTPUTS = 3; //rotation, thrust, value
+constexpr int K_NET_INPUT_SHIFT = 10; //activations are int16 with 10 fractional bits
+constexpr bool K_USE_NEURAL_POLICY = false; //runner steered by PolicyNet instead of the racing lines
+#endif
+constexpr float K_FIRST_TURN_BUDGET_MS = 500.0f; //share of the 1000ms first turn spent on precomputation
+constexpr int K_SHIELD_LOOKAHEAD = K_SHIELD_COOLDOWN + 2; //turns simulated to weigh a SHIELD against its lost thrust
+constexpr float K_CHECKPOINT_PROGRESS = 20000.0f; //progress units of one passed checkpoint
+#ifdef GOLD_LOCAL
+constexpr bool K_USE_PLANNER = false; //refine the heuristic outputs with TurnPlanner
+constexpr int K_PLAN_DEPTH = 4; //turns simulated per planner iteration
+constexpr int K_PLAN_MOVES = 8; //variations of the heuristic action tried per pod
+constexpr int K_PLAN_ARMS = K_PLAN_MOVES * K_PLAN_MOVES; //joint first turn actions of both player pods
+constexpr int K_PLAN_ITERATIONS = 4000; //per search thread and turn
+constexpr float K_PLAN_BUDGET_MS = 40.0f;
+constexpr float K_PLAN_EXPLORATION = 300.0f; //UCB1 constant in progress units
+constexpr float K_PLAN_ENEMY_NOISE_DEG = 30.0f; //how far sampled enemies may steer off their predicted target
+constexpr float K_PLAN_CONTACT_PENALTY = 500.0f; //progress units per expected enemy contact of the runner
+constexpr float K_PLAN_REUSE_DECAY = 0.1f; //share of last turn's visits kept as this turn's prior, more lets a stale plan outvote the new search
+constexpr float K_PLAN_MIN_SHARE = 0.1f; //of K_PLAN_ITERATIONS searched on a calm turn
+constexpr float K_PLAN_MAX_SHARE = 3.0f; //of K_PLAN_ITERATIONS searched on the most critical turn
+constexpr float K_PLAN_BANK_TURNS = 8.0f; //turns of saved iterations a contested stretch may draw on
+constexpr float K_PLAN_MAX_BUDGET_MS = 60.0f; //wall clock cap of a deep search, under the 75ms turn limit
+constexpr float K_CRITICAL_CHECKPOINT_DIST = 2500.0f; //distance from the checkpoint edge at which the runner's turn starts to matter
+constexpr bool K_LAZY_REPLAN = true; //with the planner on, follow the last plan while both pods stay on it
+constexpr int K_POD_PLAN_TURNS = K_PLAN_DEPTH; //turns of a pod's plan, the planner's horizon
+constexpr float K_REPLAN_POS_TOLERANCE = 50.0f;
+constexpr float K_REPLAN_SPEED_TOLERANCE = 25.0f;
+constexpr float K_REPLAN_ANGLE_TOLERANCE = 5.0f; //degrees
+constexpr float K_REPLAN_AIM_TOLERANCE = 200.0f; //how far the bumper's quarry may stray from where the plan aims
+constexpr float K_REPLAN_CONTACT = 0.25f; //expected enemy contacts along the rest of a plan that call for a new one
+constexpr bool K_PLAN_OPPONENT_POLICY = true; //planner enemies play the league policy they match best, instead of the rollout stand-in
+constexpr float K_OPPONENT_ERROR_DECAY = 0.1f; //weight of the newest turn in a policy's running prediction error
+constexpr float K_OPPONENT_BOOST_ACCEL = 300.0f; //speed change beyond thrust and friction that gives an enemy's boost away
+#endif
+constexpr int K_OCCUPANCY_CELL = 800; //one contact distance, so a cell and its 8 neighbours hold every pod that can touch a point inside it
+constexpr int K_OCCUPANCY_COLS = (K_MAP_WIDTH + K_OCCUPANCY_CELL - 1) / K_OCCUPANCY_CELL;
+constexpr int K_OCCUPANCY_ROWS = (K_MAP_HEIGHT + K_OCCUPANCY_CELL - 1) / K_OCCUPANCY_CELL;
+constexpr int K_OCCUPANCY_TURNS = 4;
+constexpr int K_OCCUPANCY_SAMPLES = 32; //trajectories per enemy and turn, a multiple of FixedPodBatch::K_LANES
+constexpr float K_OCCUPANCY_NOISE_DEG = 25.0f; //how far sampled enemies may steer off their predicted target
+constexpr float K_OCCUPANCY_DECAY = 0.5f; //weight of last turn's forecast in the updated one
+constexpr float K_CONTESTED_CONTACT = 2.0f; //expected enemy contacts along the runner's next turns that keep it on the current line
+constexpr size_t K_ARENA_BYTES = 1 << 16; //per turn scratch memory, GOLD_ARENA_DEBUG reports what is actually used
+constexpr size_t K_ARENA_ALIGN = 64;
 
 //2d math helper
 struct Vec2
@@ -75,214 +148,2242 @@ float clamp01(float x) { return std::clamp(x, 0.0f, 1.0f); }
 template<typename T>
 T lerp(T a, T b, float t) { return a + (b-a) * clamp01(t); }
 
+//wraps degrees into [0, 360)
+float NormalizeAngle(float deg)
+{
+    deg = fmod(deg, 360.0f);
+    return (deg < 0.0f) ? deg + 360.0f : deg;
+}
+
+//signed shortest rotation in degrees to get from a to b
+float AngleDiff(float a, float b)
+{
+    float d = NormalizeAngle(b - a);
+    return (d > 180.0f) ? d - 360.0f : d;
+}
+
+Vec2 AngleToDir(float deg) { return {(float)cos(deg * K_DEG_TO_RAD), (float)sin(deg * K_DEG_TO_RAD)}; }
+
+//true if the segment a->b passes within radius of center
+bool SegmentHitsCircle(Vec2 a, Vec2 b, Vec2 center, float radius)
+{
+    Vec2 ab = b - a;
+    float lenSq = ab.Dot(ab);
+    float t = (lenSq > K_EPS) ? clamp01((center - a).Dot(ab) / lenSq) : 0.0f;
+    Vec2 diff = center - (a + ab * t);
+    return diff.Dot(diff) <= radius * radius;
+}
+
+//physical state of a pod, as much as the simulation needs
+struct PodState
+{
+    Vec2 pos;
+    Vec2 velocity;
+    float angle; //degrees, negative while the pod may still face anywhere (first turn)
+    int nextCheckpointIdx;
+    int checkpointsPassedCount;
+    int shieldCooldown = 0; //turns left without thrust
+    bool boostAvailable = true;
+};
+
+//what a pod is told to do for one turn, the same choices WriteOutput can express
+struct PodAction
+{
+    Vec2 target;
+    float thrust;
+    bool shield = false;
+    bool boost = false;
+};
+
+//referee steering: rotate at most 18 degrees towards target, then accelerate along the facing
+void SimulateSteer(PodState& pod, Vec2 target, float thrust)
+{
+    float desired = NormalizeAngle((target - pod.pos).ToAngle() * K_RAD_TO_DEG);
+    if(pod.angle < 0.0f)
+        pod.angle = desired;
+    else
+        pod.angle = NormalizeAngle(pod.angle + std::clamp(AngleDiff(pod.angle, desired), -K_MAX_ROTATION_DEG, K_MAX_ROTATION_DEG));
+
+    pod.velocity = pod.velocity + AngleToDir(pod.angle) * thrust;
+}
+
+// Referee movement of a single pod ignoring everyone else. Call SimulateEndTurn afterwards.
+void SimulateMove(PodState& pod, Vec2 target, float thrust)
+{
+    SimulateSteer(pod, target, thrust);
+    pod.pos = pod.pos + pod.velocity;
+}
+
+//the referee rounds positions and truncates the damped velocity at the end of each turn
+void SimulateEndTurn(PodState& pod)
+{
+    pod.pos = {roundf(pod.pos.x), roundf(pod.pos.y)};
+    pod.velocity = {truncf(pod.velocity.x * K_FRICTION), truncf(pod.velocity.y * K_FRICTION)};
+    if(pod.shieldCooldown > 0) pod.shieldCooldown--;
+}
+
+//time within [0, maxTime] at which two pods moving straight first touch, negative if they don't
+float CollisionTime(const PodState& a, const PodState& b, float maxTime)
+{
+    double dx = a.pos.x - b.pos.x, dy = a.pos.y - b.pos.y;
+    double wx = a.velocity.x - b.velocity.x, wy = a.velocity.y - b.velocity.y;
+    double approach = dx * wx + dy * wy;
+    if(approach >= 0.0) return -1.0f; //separating pods never collide
+
+    double contact = K_POD_RADIUS * 2.0;
+    double gapSq = dx * dx + dy * dy - contact * contact;
+    if(gapSq <= 0.0) return 0.0f;
+
+    double speedSq = wx * wx + wy * wy;
+    double disc = approach * approach - speedSq * gapSq;
+    if(disc < 0.0) return -1.0f;
+
+    double t = (-approach - sqrt(disc)) / speedSq;
+    return (t <= maxTime) ? (float)t : -1.0f;
+}
+
+// Referee bounce: the elastic impulse along the contact normal is applied,
+// then applied again at a strength of at least K_MIN_IMPULSE
+void Bounce(PodState& a, float massA, PodState& b, float massB)
+{
+    Vec2 normal = a.pos - b.pos;
+    Vec2 relative = a.velocity - b.velocity;
+    float massCoeff = (massA + massB) / (massA * massB);
+    Vec2 impulse = normal * (normal.Dot(relative) / (normal.Dot(normal) * massCoeff));
+
+    a.velocity = a.velocity - impulse * (1.0f / massA);
+    b.velocity = b.velocity + impulse * (1.0f / massB);
+
+    float strength = impulse.Length();
+    if(strength > K_EPS && strength < K_MIN_IMPULSE)
+    {
+        impulse = impulse * (K_MIN_IMPULSE / strength);
+    }
+    a.velocity = a.velocity - impulse * (1.0f / massA);
+    b.velocity = b.velocity + impulse * (1.0f / massB);
+}
+
+//moves pods along their velocity for part of a turn, counting the checkpoints they cross
+void AdvancePods(PodState* pods, int count, float time, const Vec2* checkpoints, int checkpointCount)
+{
+    for(int i=0; i < count; ++i)
+    {
+        PodState& pod = pods[i];
+        Vec2 from = pod.pos;
+        pod.pos = pod.pos + pod.velocity * time;
+        if(SegmentHitsCircle(from, pod.pos, checkpoints[pod.nextCheckpointIdx], K_CHECKPOINT_RADIUS))
+        {
+            pod.nextCheckpointIdx = (pod.nextCheckpointIdx+1)%checkpointCount;
+            pod.checkpointsPassedCount++;
+        }
+    }
+}
+
+// A full referee turn: apply every pod's action, move them resolving pod collisions
+// in time order, count checkpoints, then round and damp. A shielded pod weighs
+// K_SHIELD_MASS that turn and cannot thrust for the next K_SHIELD_COOLDOWN turns;
+// BOOST without a boost left is full thrust.
+void SimulateTurn(PodState* pods, const PodAction* actions, int count, const Vec2* checkpoints, int checkpointCount)
+{
+    constexpr int maxCollisions = 16;
+    float mass[K_TOTAL_SHIPCOUNT];
+
+    for(int i=0; i < count; ++i)
+    {
+        PodState& pod = pods[i];
+        const PodAction& action = actions[i];
+        float thrust = action.thrust;
+        mass[i] = action.shield ? K_SHIELD_MASS : 1.0f;
+
+        if(action.shield)
+        {
+            thrust = 0.0f;
+            pod.shieldCooldown = K_SHIELD_COOLDOWN + 1; //SimulateEndTurn takes this turn off
+        }
+        else if(pod.shieldCooldown > 0)
+        {
+            thrust = 0.0f;
+        }
+        else if(action.boost)
+        {
+            thrust = pod.boostAvailable ? K_BOOST_THRUST : K_MAX_THRUST;
+            pod.boostAvailable = false;
+        }
+        SimulateSteer(pod, action.target, thrust);
+    }
+
+    float time = 0.0f;
+    for(int collisions=0; collisions < maxCollisions && time < 1.0f; ++collisions)
+    {
+        int first = -1, second = -1;
+        float firstTime = 1.0f - time;
+        for(int i=0; i < count; ++i)
+        {
+            for(int j=i+1; j < count; ++j)
+            {
+                float t = CollisionTime(pods[i], pods[j], firstTime);
+                if(t >= 0.0f && (first < 0 || t < firstTime))
+                {
+                    first = i;
+                    second = j;
+                    firstTime = t;
+                }
+            }
+        }
+        if(first < 0) break;
+
+        AdvancePods(pods, count, firstTime, checkpoints, checkpointCount);
+        Bounce(pods[first], mass[first], pods[second], mass[second]);
+        time += firstTime;
+    }
+    AdvancePods(pods, count, std::max(1.0f - time, 0.0f), checkpoints, checkpointCount);
+
+    for(int i=0; i < count; ++i)
+    {
+        SimulateEndTurn(pods[i]);
+    }
+}
+
+//true if drifting without thrust carries the pod through the checkpoint within the given turns
+bool WillCoastThrough(const PodState& pod, Vec2 checkpoint, int turns)
+{
+    constexpr float margin = 50.0f;
+    Vec2 pos = pod.pos;
+    Vec2 velocity = pod.velocity;
+    for(int i=0; i < turns; ++i)
+    {
+        Vec2 next = pos + velocity;
+        if(SegmentHitsCircle(pos, next, checkpoint, K_CHECKPOINT_RADIUS - margin)) return true;
+        pos = next;
+        velocity = velocity * K_FRICTION;
+    }
+    return false;
+}
+
+//full thrust when facing the target, cut it as the heading error grows
+float RacingThrust(const PodState& pod, Vec2 target)
+{
+    if(pod.angle < 0.0f) return K_MAX_THRUST;
+    float error = abs(AngleDiff(pod.angle, (target - pod.pos).ToAngle() * K_RAD_TO_DEG));
+    return K_MAX_THRUST * clamp01((90.0f - error) / 60.0f);
+}
+
+// cos/sin scaled by 2^K_TRIG_SHIFT, sampled every 2^K_TRIG_FRAC_BITS heading units
+// with one extra entry so lookups can interpolate without wrapping
+struct FixedTrigTable
+{
+    int32_t cos[K_TRIG_ENTRIES + 1];
+    int32_t sin[K_TRIG_ENTRIES + 1];
+
+    FixedTrigTable()
+    {
+        for(int i=0; i <= K_TRIG_ENTRIES; ++i)
+        {
+            double rad = i * (2.0 * M_PI / K_TRIG_ENTRIES);
+            cos[i] = (int32_t)lround(std::cos(rad) * (1 << K_TRIG_SHIFT));
+            sin[i] = (int32_t)lround(std::sin(rad) * (1 << K_TRIG_SHIFT));
+        }
+    }
+};
+const FixedTrigTable fixedTrig;
+
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#pragma GCC optimize("tree-vectorize")
+
+// Integer movement kernel for pods that fly alone, K_LANES pods at a time, used to sample
+// the enemies of EnemyOccupancy. It is not a physics backend: SimulateTurn stays the only
+// referee model, as this has no collisions, shield, boost or checkpoint counting.
+// Between turns positions and velocities are whole units like in the referee; within
+// a turn the velocity carries K_FIXED_SHIFT fractional bits, so rounding the position
+// and truncating the damped velocity match the referee. Headings are binary angles of
+// K_ANGLE_BITS bits, the one approximation left; bench's physics/error measures its cost.
+// Every array is an int32 lane so Step compiles to AVX2.
+struct FixedPodBatch
+{
+    static constexpr int K_LANES = 8;
+
+    alignas(32) int32_t x[K_LANES];
+    alignas(32) int32_t y[K_LANES];
+    alignas(32) int32_t vx[K_LANES];
+    alignas(32) int32_t vy[K_LANES];
+    alignas(32) int32_t angle[K_LANES]; //-1 while the pod may still face anywhere
+
+    static int32_t ToFixedAngle(double deg)
+    {
+        double turns = deg / 360.0;
+        return (int32_t)llround((turns - floor(turns)) * K_ANGLE_STEPS) & (K_ANGLE_STEPS - 1);
+    }
+
+    void Set(int lane, const PodState& pod)
+    {
+        x[lane] = (int32_t)lroundf(pod.pos.x);
+        y[lane] = (int32_t)lroundf(pod.pos.y);
+        vx[lane] = (int32_t)pod.velocity.x;
+        vy[lane] = (int32_t)pod.velocity.y;
+        angle[lane] = (pod.angle < 0.0f) ? -1 : ToFixedAngle(pod.angle);
+    }
+
+    //writes the physical part back, checkpoint progress is left untouched
+    void Get(int lane, PodState& pod) const
+    {
+        pod.pos = {(float)x[lane], (float)y[lane]};
+        pod.velocity = {(float)vx[lane], (float)vy[lane]};
+        pod.angle = (angle[lane] < 0) ? -1.0f : angle[lane] * (360.0f / K_ANGLE_STEPS);
+    }
+
+    //rotation in heading units that turns the lane towards target, like SimulateMove does
+    int32_t Aim(int lane, Vec2 target)
+    {
+        int32_t desired = ToFixedAngle(atan2((double)target.y - y[lane], (double)target.x - x[lane]) * (180.0 / M_PI));
+        if(angle[lane] < 0)
+        {
+            angle[lane] = desired;
+            return 0;
+        }
+        //wrap the difference into [-half turn, half turn)
+        return (int32_t)((uint32_t)(desired - angle[lane]) << (32 - K_ANGLE_BITS)) >> (32 - K_ANGLE_BITS);
+    }
+
+    // One full turn for every lane: rotate (clamped to 18 degrees), accelerate, move,
+    // round the position and truncate the damped velocity. Lanes must have a heading.
+    void Step(const int32_t* __restrict rotation, const int32_t* __restrict thrust)
+    {
+        const int32_t* cosTable = fixedTrig.cos;
+        const int32_t* sinTable = fixedTrig.sin;
+        constexpr int32_t half = 1 << (K_FIXED_SHIFT - 1);
+        constexpr int32_t trigHalf = 1 << (K_TRIG_SHIFT - K_FIXED_SHIFT - 1);
+        constexpr int32_t maxRotation = (int32_t)(K_ANGLE_STEPS / 20); //18 degrees
+        constexpr int32_t fracMask = (1 << K_TRIG_FRAC_BITS) - 1;
+        #pragma GCC ivdep //the trig tables never alias the lanes
+        for(int l=0; l < K_LANES; ++l)
+        {
+            int32_t a = (angle[l] + std::clamp(rotation[l], -maxRotation, maxRotation)) & (K_ANGLE_STEPS - 1);
+            angle[l] = a;
+
+            int32_t i = a >> K_TRIG_FRAC_BITS;
+            int32_t frac = a & fracMask;
+            int32_t c = cosTable[i] + (((cosTable[i+1] - cosTable[i]) * frac) >> K_TRIG_FRAC_BITS);
+            int32_t s = sinTable[i] + (((sinTable[i+1] - sinTable[i]) * frac) >> K_TRIG_FRAC_BITS);
+
+            int32_t fvx = vx[l] * (1 << K_FIXED_SHIFT) + ((thrust[l] * c + trigHalf) >> (K_TRIG_SHIFT - K_FIXED_SHIFT));
+            int32_t fvy = vy[l] * (1 << K_FIXED_SHIFT) + ((thrust[l] * s + trigHalf) >> (K_TRIG_SHIFT - K_FIXED_SHIFT));
+
+            //the position is whole, so round(x + v) only needs floor(v + 0.5) of the fraction
+            x[l] += (fvx + half) >> K_FIXED_SHIFT;
+            y[l] += (fvy + half) >> K_FIXED_SHIFT;
+
+            //trunc(v * 17/20) split as 17q + 17r/20 so the product cannot overflow
+            int32_t dampedX = (fvx / 20) * 17 + ((fvx % 20) * 17) / 20;
+            int32_t dampedY = (fvy / 20) * 17 + ((fvy % 20) * 17) / 20;
+            vx[l] = dampedX / (1 << K_FIXED_SHIFT);
+            vy[l] = dampedY / (1 << K_FIXED_SHIFT);
+        }
+    }
+};
+
+#pragma GCC pop_options
+
+#ifdef GOLD_LOCAL
+// Policy and value network weights, distilled from the racing line controller over
+// simulated laps on random tracks by distill.cpp, which prints this block. Weights are
+// int8 with a per layer power of two scale, biases are int32 already at the scale of the
+// layer's accumulator. The network races a few percent slower than the controller and
+// nothing uses its value yet, so only the GOLD_LOCAL build has it.
+constexpr int K_NET_SHIFT1 = 4;
+constexpr int K_NET_SHIFT2 = 4;
+constexpr int K_NET_SHIFT3 = 6;
+alignas(32) constexpr int8_t K_NET_W1[K_NET_HIDDEN * K_NET_INPUTS] = {
+    -7, -21, 27, 53, 0, 0, -5, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    4, -21, 7, 32, -3, 4, 22, -5, 0, 0, 0, 0, 0, 0, 0, 0,
+    -15, -7, 1, 0, -2, 1, 27, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    1, -18, -15, 28, 0, 2, 4, 2, 0, 0, 0, 0, 0, 0, 0, 0,
+    -12, 18, 33, -45, 1, 1, 1, -1, 0, 0, 0, 0, 0, 0, 0, 0,
+    6, -21, 16, 46, 0, -1, -13, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    -12, -16, 20, 25, 0, 1, 3, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    -1, 38, 10, -56, 0, 1, 12, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    -4, -10, -2, 32, 0, 0, -13, 1, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 18, 2, -61, 2, 2, 10, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    5, -4, 2, 46, 1, -1, 21, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    17, -5, 11, 27, -1, 0, -29, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    1, -9, 15, 35, 0, 0, -50, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    10, -6, -1, 25, -6, 7, -52, -8, 0, 0, 0, 0, 0, 0, 0, 0,
+    12, 23, -26, 10, 1, 4, -53, -2, 0, 0, 0, 0, 0, 0, 0, 0,
+    1, 8, 2, -28, 1, -19, -3, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 1, -5, 1, -10, -7, -15, 0, 0, 0, 0, 0, 0, 0, 0,
+    -23, 0, 51, 1, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    2, -15, -5, 64, 1, -1, 5, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 4, 2, -12, 14, -8, -4, -12, 0, 0, 0, 0, 0, 0, 0, 0,
+    -4, -19, -8, 29, -1, -2, 36, 1, 0, 0, 0, 0, 0, 0, 0, 0,
+    3, -7, -8, 14, -5, 14, -16, -8, 0, 0, 0, 0, 0, 0, 0, 0,
+    -18, -17, 13, -16, -3, -2, -3, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    4, -1, 3, -2, -2, 2, 3, 5, 0, 0, 0, 0, 0, 0, 0, 0,
+    12, -6, 4, -19, 3, -3, -1, -3, 0, 0, 0, 0, 0, 0, 0, 0,
+    2, -2, 5, 2, 20, 15, -19, -20, 0, 0, 0, 0, 0, 0, 0, 0,
+    24, -3, -80, 11, 1, -1, 15, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    1, 1, 21, 9, 8, 4, -22, -7, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 1, -1, -3, 3, 11, 6, -4, 0, 0, 0, 0, 0, 0, 0, 0,
+    17, 21, -51, -45, 0, 1, 11, -1, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 11, 19, 2, 1, 0, 2, -1, 0, 0, 0, 0, 0, 0, 0, 0,
+    17, -9, 2, -16, 2, -1, -56, -1, 0, 0, 0, 0, 0, 0, 0, 0
+};
+alignas(32) constexpr int32_t K_NET_B1[K_NET_HIDDEN] = {
+    -2903, -10005, 64, 1677, -2312, 3201, 1935, 3788,
+    9131, -5054, -12315, -222, 8174, 4985, 1456, 1526,
+    0, -1525, -3378, 3442, -2040, 6145, 1334, -450,
+    531, 5518, -2558, 2690, -295, -2507, -2241, 3633
+};
+alignas(32) constexpr int8_t K_NET_W2[K_NET_HIDDEN * K_NET_HIDDEN] = {
+    8, 18, 7, -8, 2, -6, -8, 20, 5, 9, -25, 0, 1, 0, 4, 4,
+    4, -4, -17, 7, -10, -6, 5, 0, -6, -1, -37, 7, 5, 19, 6, 36,
+    -20, 9, 0, -7, -2, -8, 0, 11, -6, 19, -5, -1, 36, -5, -4, 0,
+    -5, -10, -4, 7, 2, -13, 15, 3, 2, -12, -17, -13, 9, -2, 3, 24,
+    2, 7, 2, -9, -12, -7, -3, 14, 22, 5, -23, 9, -20, 10, 11, 0,
+    -5, -6, -21, -1, -6, 0, 9, -7, -10, -9, -15, 6, 1, 5, 18, 39,
+    4, 0, -4, -3, 8, -2, 5, -9, 11, -1, 17, 3, 8, -15, 17, 1,
+    -1, 0, -21, 9, -10, -3, 6, 7, 1, 4, -28, 7, -8, -1, 3, 30,
+    -22, -3, 16, -12, 2, 13, 13, 3, 5, 1, 1, -10, -1, -38, 16, 2,
+    2, 7, -3, 11, -7, 1, -1, -9, -10, 5, -24, 1, 6, -16, -1, -25,
+    -53, 0, 4, -9, -62, 2, 8, 4, 8, -36, -10, 3, -9, 10, 5, -36,
+    -2, -85, -15, 11, -4, 2, 4, -2, -3, -4, -8, 23, 5, -15, 7, 11,
+    13, -7, 11, 3, 3, 13, 3, -12, -7, -13, 2, -5, 12, 5, 33, -3,
+    -4, 9, 2, 3, 18, 5, -10, -2, 7, 0, 9, 2, 4, -27, -3, -4,
+    8, 10, -4, 11, -5, -8, -1, 15, -6, -3, -4, -10, -2, -19, -29, 0,
+    0, 9, -13, 6, 5, -10, 2, -4, 0, 1, -1, 0, 5, 15, 10, 22,
+    -3, -15, 7, 11, 5, 5, 4, -18, -8, -24, 14, 2, 14, 8, 3, -2,
+    -1, 2, 8, -4, 13, 8, -11, 4, 11, 10, 8, 6, -1, -23, 7, -3,
+    -40, -12, 20, -10, -27, 11, 7, 5, -1, -7, 7, 0, 2, -13, 15, -2,
+    -4, -64, -10, 18, -2, -3, -4, -23, 8, 6, -8, 17, 24, -21, 5, 11,
+    2, 9, -26, 0, -4, -19, 6, 8, -4, 15, -7, -15, -9, -24, -34, 1,
+    -1, -20, -14, -1, -2, -16, 15, -2, -6, -18, 19, -13, 4, 9, 4, 12,
+    -94, -15, 6, -2, -47, 10, 17, -8, -1, -33, 48, 6, 0, 16, 33, 0,
+    1, -95, -14, -1, 5, 6, -3, -6, 10, 0, -20, 19, 1, -8, -10, -11,
+    -4, -8, -11, 1, -19, 8, -6, -13, 3, 4, -2, 0, -9, 9, -7, -2,
+    5, -22, 6, -4, 7, 7, 0, 4, 7, -1, 6, -8, -2, 32, 0, -27,
+    11, -6, -5, 14, -1, -18, -13, 5, 16, -1, -1, -4, -31, -8, -9, 1,
+    0, -1, 2, -5, 12, -4, -8, -1, -1, 2, 14, -9, -15, 12, 7, -1,
+    -48, -8, 9, -4, -46, 2, 7, 5, -1, -5, 11, 9, 3, 22, 34, -81,
+    -1, -48, -20, -15, 5, 2, -1, -6, 5, -2, -26, 6, 2, -26, 3, 10,
+    10, -10, -3, 2, 0, -11, 14, 2, -12, 1, 7, -19, -34, -7, -12, -2,
+    -1, 0, 5, -17, -10, 9, 4, 4, 9, 14, -18, -6, -6, 18, -7, 18,
+    0, 2, 0, -13, 4, -7, 1, 3, -7, 3, -11, -14, -14, 15, -20, 1,
+    1, 19, -1, 13, -5, 3, -2, 6, 2, 12, 19, -2, 4, 6, 6, -3,
+    -2, -6, -1, 0, 0, 8, 12, -22, 5, -1, -2, -5, 11, -12, 8, -4,
+    1, 14, 13, -1, 11, 13, -5, 0, 7, 3, 10, -7, -6, -20, 0, -13,
+    3, 13, -4, 0, 12, 1, -4, -11, 1, 2, -13, 22, 7, 8, 29, 2,
+    3, -1, 10, -8, -9, -4, -5, 13, 5, 4, 2, 5, -8, 0, -1, -2,
+    -60, 21, 7, 1, -6, -11, -4, 15, 17, -7, 28, 22, 11, 3, 9, 1,
+    -3, -8, -35, 0, -1, -8, 7, -3, 1, 1, 2, -9, -2, 0, -1, 16,
+    16, -16, 2, 4, -6, 3, -3, 6, 10, -33, 20, 7, -6, 28, -12, -5,
+    -4, 1, -2, -13, 2, 2, 1, -6, -6, 8, -5, 1, 0, 9, -6, -16,
+    -16, 13, -20, 5, 11, -11, -2, 11, -5, 10, 6, 0, -7, -3, -22, 3,
+    -1, -39, -19, -1, 7, -21, 7, -8, -10, -18, 3, -9, 7, 1, -7, 26,
+    -14, 6, -6, 1, -5, -19, 4, 3, -1, 5, 3, -20, -18, -16, -21, 3,
+    0, 5, 1, -3, -18, -4, -1, 5, -2, 0, 20, 3, -4, 24, -2, -11,
+    4, -4, -3, 3, 8, 2, -4, -10, -10, 6, 4, 13, -4, 3, 5, 1,
+    8, 0, -1, -5, -1, 6, -5, 15, 5, -4, 5, -1, -9, 19, -1, -42,
+    20, -2, -6, -12, 5, -14, 5, 1, 2, 3, -17, -18, -5, 23, -28, 0,
+    4, -7, 15, -5, 6, -4, -5, 2, 4, -2, 22, 3, 4, 3, -2, -18,
+    13, 1, 2, 9, -6, -1, -19, 2, -4, 3, -7, -2, -2, -14, 0, -1,
+    4, -54, -3, -5, -4, 0, -3, 4, 2, -2, 0, 3, -6, -3, 2, -7,
+    2, -18, -5, 1, 8, 5, 2, -17, -1, 6, 13, -3, 3, 3, -16, -5,
+    -1, 6, 23, -10, 7, 11, -7, 2, 5, 9, 7, -5, -6, -17, -10, -27,
+    -4, 4, -5, -21, -3, 4, 0, -6, 9, -2, -10, 0, 1, -16, 7, -4,
+    -8, 9, 6, 11, 3, 6, 9, -1, -2, 3, 4, -17, 7, 10, -4, 26,
+    6, -4, 3, -5, -11, -2, 2, 1, -4, 2, -3, -7, -3, -2, 2, -3,
+    7, 1, -4, -6, -3, 3, -1, 0, -2, 2, -7, -5, -1, -2, 4, 3,
+    2, 7, -13, -9, -7, -11, -4, -3, 19, 5, -21, 0, -16, -7, 6, -2,
+    -2, 4, 15, -17, 6, 4, 0, 10, 7, 13, -3, -7, -4, -12, 14, 9,
+    -16, -8, 12, 15, -20, 3, 10, -17, 0, -39, 12, 15, 25, 6, 9, 0,
+    -2, 0, -2, 1, -1, 10, 0, 0, 3, 3, 2, 7, -3, -80, 24, 22,
+    -13, 19, -3, -10, 4, -2, -5, 9, -10, -5, -40, 0, 4, 21, -8, 4,
+    1, 9, -24, 11, -8, 7, -1, 8, 5, 8, -20, 9, 0, 15, 5, 3
+};
+alignas(32) constexpr int32_t K_NET_B2[K_NET_HIDDEN] = {
+    -7875, -5313, 764, 6583, -20, 1809, -6110, 3534,
+    5361, -5322, 7572, 1087, 6878, 3979, 2342, 4436,
+    313, 4077, 5712, -12741, -4153, 10445, 10477, 12309,
+    4935, 13025, 81, 3185, -1977, -2163, -8256, 6979
+};
+alignas(32) constexpr int8_t K_NET_W3[K_NET_OUTPUTS * K_NET_HIDDEN] = {
+    67, -46, -42, -2, -2, 66, -49, -4, 60, 2, 75, -77, 3, -2, 77, -8,
+    -8, 46, 6, 11, 24, -48, -42, -4, 2, -1, -50, 6, 12, -15, -33, -24,
+    -8, -2, 0, 6, 24, -4, -11, 28, 3, 79, 13, -1, -34, -4, -9, 0,
+    -26, 2, -1, -3, 2, -30, 3, 26, 18, -41, 5, 8, -12, 5, -3, 3,
+    0, 7, -2, -37, 4, -9, 4, 18, -8, 18, 8, -10, -2, 30, 7, 27,
+    7, 7, 32, -44, -7, -8, -2, -6, -31, -2, 11, 20, -2, -27, -6, -11
+};
+alignas(32) constexpr int32_t K_NET_B3[K_NET_OUTPUTS] = {
+    1488, 17702, 43196
+};
+
+// Network inputs: the pod's velocity and the next two checkpoint legs seen from the
+// pod's heading, scaled to roughly [-1, 1]. Unused inputs stay zero.
+void PolicyFeatures(const PodState& pod, Vec2 next, Vec2 afterNext, float* features)
+{
+    Vec2 forward = (pod.angle < 0.0f) ? (next - pod.pos).Normalized() : AngleToDir(pod.angle);
+    Vec2 side = {-forward.y, forward.x};
+    Vec2 toNext = next - pod.pos;
+    Vec2 leg = afterNext - next;
+
+    std::fill(features, features + K_NET_INPUTS, 0.0f);
+    features[0] = pod.velocity.Dot(forward) / 1000.0f;
+    features[1] = pod.velocity.Dot(side) / 1000.0f;
+    features[2] = toNext.Dot(forward) / 10000.0f;
+    features[3] = toNext.Dot(side) / 10000.0f;
+    features[4] = leg.Dot(forward) / 10000.0f;
+    features[5] = leg.Dot(side) / 10000.0f;
+    features[6] = toNext.Length() / 10000.0f;
+    features[7] = leg.Length() / 10000.0f;
+}
+
+struct PolicyOutput
+{
+    float rotation; //degrees, within +-18
+    float thrust;   //0 to K_MAX_THRUST
+    float value;    //predicted turns until the next checkpoint
+};
+
+#pragma GCC push_options
+#pragma GCC target("avx2")
+
+// out[j] = bias[j] + sum of in[i] * weights[j][i], using int16 x int16 pair products
+// (vpmaddwd) with the int8 weights widened on load
+template<int IN, int OUT>
+void DenseLayer(const int16_t* in, const int8_t* weights, const int32_t* bias, int32_t* out)
+{
+    static_assert(IN % 16 == 0, "layer inputs must fill whole registers");
+    for(int j=0; j < OUT; ++j)
+    {
+        __m256i acc = _mm256_setzero_si256();
+        for(int i=0; i < IN; i += 16)
+        {
+            __m256i x = _mm256_load_si256((const __m256i*)(in + i));
+            __m256i w = _mm256_cvtepi8_epi16(_mm_load_si128((const __m128i*)(weights + j * IN + i)));
+            acc = _mm256_add_epi32(acc, _mm256_madd_epi16(x, w));
+        }
+        __m128i sum = _mm_add_epi32(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+        sum = _mm_hadd_epi32(sum, sum);
+        sum = _mm_hadd_epi32(sum, sum);
+        out[j] = _mm_cvtsi128_si32(sum) + bias[j];
+    }
+}
+
+//back to int16 activations: drop the weight scale, ReLU and saturate
+template<int N>
+void Activate(const int32_t* acc, int shift, int16_t* out)
+{
+    for(int i=0; i < N; ++i)
+    {
+        out[i] = (int16_t)std::clamp(acc[i] >> shift, 0, 32767);
+    }
+}
+
+// Forward pass of the quantized policy/value network, a couple hundred nanoseconds,
+// cheap enough to evaluate search leaves with
+PolicyOutput RunPolicyNet(const float* features)
+{
+    alignas(32) int16_t input[K_NET_INPUTS];
+    alignas(32) int16_t hidden1[K_NET_HIDDEN];
+    alignas(32) int16_t hidden2[K_NET_HIDDEN];
+    alignas(32) int32_t acc[K_NET_HIDDEN];
+
+    for(int i=0; i < K_NET_INPUTS; ++i)
+    {
+        input[i] = (int16_t)std::clamp((int)lroundf(features[i] * (1 << K_NET_INPUT_SHIFT)), -32767, 32767);
+    }
+
+    DenseLayer<K_NET_INPUTS, K_NET_HIDDEN>(input, K_NET_W1, K_NET_B1, acc);
+    Activate<K_NET_HIDDEN>(acc, K_NET_SHIFT1, hidden1);
+    DenseLayer<K_NET_HIDDEN, K_NET_HIDDEN>(hidden1, K_NET_W2, K_NET_B2, acc);
+    Activate<K_NET_HIDDEN>(acc, K_NET_SHIFT2, hidden2);
+    DenseLayer<K_NET_HIDDEN, K_NET_OUTPUTS>(hidden2, K_NET_W3, K_NET_B3, acc);
+
+    float scale = 1.0f / (1 << (K_NET_INPUT_SHIFT + K_NET_SHIFT3));
+    PolicyOutput result;
+    result.rotation = std::clamp(acc[0] * scale, -1.0f, 1.0f) * K_MAX_ROTATION_DEG;
+    result.thrust = clamp01(acc[1] * scale) * K_MAX_THRUST;
+    result.value = std::max(acc[2] * scale * 10.0f, 0.0f);
+    return result;
+}
+
+#pragma GCC pop_options
+#endif
+
+//how to go through a checkpoint, found by GameState::OptimizeRacingLines
+struct RacingLine
+{
+    Vec2 entry;   //crossing point inside the checkpoint
+    Vec2 heading; //normalized direction of travel when crossing
+    int leadTurns; //start turning for the following checkpoint once coasting crosses within this many turns
+};
+
 enum Command
 {
     SeekCheckpoint,
     BumpStrongestEnemy
 };
 
-struct Ship
+//why a pod did or did not shield this turn, for telemetry
+enum ShieldReason : uint8_t
+{
+    ShieldNotThreatened,
+    ShieldNoGain,
+    ShieldGain,
+    ShieldPlanned, //the planner overrode the evaluator
+    ShieldReasonCount
+};
+
+//why a pod did or did not boost this turn, for telemetry
+enum BoostReason : uint8_t
+{
+    BoostNotRunner,
+    BoostSpent,
+    BoostWrongLeg,
+    BoostNotAligned,
+    BoostLowThrust,
+    BoostFired,
+    BoostPlanned, //the planner overrode the evaluator
+    BoostReasonCount
+};
+
+//the league bots' decision rules, as the policy zoo simulates them
+enum PolicyKind : uint8_t
+{
+    PolicyWood2,
+    PolicyWood1,
+    PolicyBronze,
+    PolicySilver,
+    PolicyGold,
+    PolicyKindCount
+};
+
+const char* K_POLICY_NAMES[PolicyKindCount] = {"wood2", "wood1", "bronze", "silver", "gold"};
+
+//why a pod could not keep following its plan this turn, for the replan counters and telemetry
+enum ReplanReason : uint8_t
+{
+    ReplanNone, //followed the plan
+    ReplanNoPlan, //none made yet, or used up
+    ReplanDeviation,
+    ReplanThreat,
+    ReplanBoost, //plans never boost, the heuristics decide when
+    ReplanReasonCount
+};
+
+const char* K_SHIELD_REASON_NAMES[ShieldReasonCount] = {"not_threatened", "no_gain", "gain", "planned"};
+const char* K_BOOST_REASON_NAMES[BoostReasonCount] = {"not_runner", "spent", "wrong_leg", "not_aligned", "low_thrust", "fired", "planned"};
+const char* K_REPLAN_REASON_NAMES[ReplanReasonCount] = {"on_plan", "no_plan", "deviation", "threat", "boost"};
+
+#ifdef GOLD_LOCAL
+// What a player pod meant to do over the turns after its last replan and where that should
+// have taken it: actions[k] is sent k turns after the replan, from states[k].
+struct PodPlan
+{
+    PodState states[K_POD_PLAN_TURNS];
+    PodAction actions[K_POD_PLAN_TURNS];
+    int length = 0;
+    int step = 0; //next entry to follow
+};
+#endif
+
+struct Ship
+{
+    // inputs
+    Vec2 pos;
+    Vec2 velocity;
+    float angle;
+    int nextCheckpointIdx;
+    int checkpointsPassedCount = 0;
+    int shieldCooldown = 0; //tracked from our own outputs, the referee does not send it
+
+    PodState State() const { return {pos, velocity, angle, nextCheckpointIdx, checkpointsPassedCount, shieldCooldown}; }
+
+    //helper vars
+    int id;
+    bool isPlayer;
+    float nextCheckpointAngle; //degrees
+    Vec2 dest;
+
+    //simulation specific
+    Command command = Command::SeekCheckpoint;
+
+    //outputs
+    Vec2 targetCoord;
+    float thrust;
+    bool doShield;
+    bool doBoost;
+    ShieldReason shieldReason = ShieldNotThreatened;
+    float shieldGain = 0.0f; //simulated progress the shield wins, when threatened
+    BoostReason boostReason = BoostNotRunner;
+    ReplanReason replanReason = ReplanNoPlan;
+
+#ifdef GOLD_LOCAL
+    PodPlan plan; //kept across turns
+#endif
+
+    //the outputs as WriteOutput would send them
+    PodAction Action() const { return {targetCoord, std::clamp(thrust, 0.0f, K_MAX_THRUST), doShield, !doShield && doBoost}; }
+};
+
+#ifdef GOLD_LOCAL
+// Visit counts and summed scores of every joint first turn action. Searches running on
+// different threads each fill their own and are merged afterwards.
+struct PlanStats
+{
+    int visits[K_PLAN_ARMS];
+    float score[K_PLAN_ARMS];
+
+    void Merge(const PlanStats& other)
+    {
+        for(int i=0; i < K_PLAN_ARMS; ++i)
+        {
+            visits[i] += other.visits[i];
+            score[i] += other.score[i];
+        }
+    }
+
+    //most visited arm, ties go to the better mean
+    int Best() const
+    {
+        int best = 0;
+        for(int i=1; i < K_PLAN_ARMS; ++i)
+        {
+            if(visits[i] > visits[best] || (visits[i] == visits[best] && visits[i] > 0 && score[i] / visits[i] > score[best] / visits[best])) best = i;
+        }
+        return best;
+    }
+
+    //these statistics as a prior for the next turn's search, every arm's weight scaled by decay
+    PlanStats Decayed(float decay) const
+    {
+        PlanStats prior = {};
+        for(int i=0; i < K_PLAN_ARMS; ++i)
+        {
+            prior.visits[i] = (int)(visits[i] * decay);
+            if(prior.visits[i] > 0) prior.score[i] = score[i] / visits[i] * prior.visits[i];
+        }
+        return prior;
+    }
+
+    bool operator== (const PlanStats& other) const
+    {
+        return std::equal(visits, visits + K_PLAN_ARMS, other.visits) && std::equal(score, score + K_PLAN_ARMS, other.score);
+    }
+};
+#endif
+
+//splitmix64, cheap to seed into independent streams
+struct PlanRng
+{
+    uint64_t state;
+
+    uint64_t Next()
+    {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    float Uniform() { return (Next() >> 40) * (1.0f / (1 << 24)); } //[0, 1)
+};
+
+//fixed capacity array over arena memory, Push returns nullptr once it is full
+template<typename T>
+struct FixedArray
+{
+    T* items;
+    int count;
+    int capacity;
+
+    T* Push(const T& item)
+    {
+        if(count >= capacity) return nullptr;
+        items[count] = item;
+        return &items[count++];
+    }
+
+    T& operator[] (int idx) { return items[idx]; }
+    const T& operator[] (int idx) const { return items[idx]; }
+    T* begin() { return items; }
+    T* end() { return items + count; }
+};
+
+// Bump pointer memory for everything a turn needs as scratch. Sized once when the track is
+// known, handed out during DecideTurn and released all at once by Reset at the start of the
+// next turn, so the turn loop never calls malloc. A copy gets its own empty buffer of the
+// same size, scratch never outlives the turn that made it.
+struct Arena
+{
+    uint8_t* buffer = nullptr;
+    size_t capacity = 0;
+    size_t used = 0;
+    size_t highWater = 0;
+
+    Arena() = default;
+    Arena(const Arena& other) { Reserve(other.capacity); }
+    Arena& operator= (const Arena& other)
+    {
+        if(this != &other) Reserve(other.capacity);
+        return *this;
+    }
+    ~Arena() { free(buffer); }
+
+    void Reserve(size_t bytes)
+    {
+        if(bytes != capacity)
+        {
+            free(buffer);
+            buffer = bytes ? (uint8_t*)aligned_alloc(K_ARENA_ALIGN, bytes) : nullptr;
+            capacity = bytes;
+        }
+        used = 0;
+    }
+
+    void Reset()
+    {
+#ifdef GOLD_ARENA_DEBUG
+        if(used > highWater) cerr << "arena high water " << used << " of " << capacity << " bytes" << endl;
+#endif
+        highWater = max(highWater, used);
+        used = 0;
+    }
+
+    void* Alloc(size_t bytes, size_t align)
+    {
+        size_t start = (used + align - 1) & ~(align - 1);
+        if(start + bytes > capacity)
+        {
+            cerr << "arena exhausted, " << start + bytes << " of " << capacity << " bytes" << endl;
+            abort();
+        }
+        used = start + bytes;
+        return buffer + start;
+    }
+
+    //count value initialized objects, nothing runs their destructors
+    template<typename T>
+    T* New(int count = 1)
+    {
+        static_assert(is_trivially_destructible<T>::value, "arena objects are never destroyed");
+        T* items = (T*)Alloc(sizeof(T) * count, max(alignof(T), (size_t)alignof(max_align_t)));
+        for(int i=0; i < count; ++i) new(items + i) T();
+        return items;
+    }
+
+    template<typename T>
+    FixedArray<T> Array(int capacity) { return {New<T>(capacity), 0, capacity}; }
+};
+
+// For each of the next K_OCCUPANCY_TURNS turns, the probability that an enemy pod comes within
+// contact distance of each cell of a coarse grid over the map. Every Update samples perturbed
+// enemy trajectories in FixedPodBatch lanes and blends them with last turn's forecast, shifted
+// by the turn that passed.
+struct EnemyOccupancy
+{
+    float probability[K_OCCUPANCY_TURNS][K_OCCUPANCY_ROWS][K_OCCUPANCY_COLS] = {};
+    bool primed = false;
+    PlanRng rng = {0x5EEDull};
+
+    static int Col(int x) { return std::clamp(x / K_OCCUPANCY_CELL, 0, K_OCCUPANCY_COLS - 1); }
+    static int Row(int y) { return std::clamp(y / K_OCCUPANCY_CELL, 0, K_OCCUPANCY_ROWS - 1); }
+
+    //enemy contact probability around pos, turn 0 is the one being decided
+    float At(int turn, Vec2 pos) const
+    {
+        return probability[turn][Row((int)pos.y)][Col((int)pos.x)];
+    }
+
+    void Update(const PodState* enemies, int enemyCount, const Vec2* checkpoints, Arena& arena)
+    {
+        constexpr int lanes = FixedPodBatch::K_LANES;
+        constexpr int32_t noise = (int32_t)(K_ANGLE_STEPS * (K_OCCUPANCY_NOISE_DEG / 360.0f));
+        constexpr int cells = K_OCCUPANCY_TURNS * K_OCCUPANCY_ROWS * K_OCCUPANCY_COLS;
+
+        //one grid per turn, zeroed by New
+        auto fresh = (float(*)[K_OCCUPANCY_ROWS][K_OCCUPANCY_COLS])arena.New<float>(cells);
+        auto hits = (uint16_t(*)[K_OCCUPANCY_ROWS][K_OCCUPANCY_COLS])arena.New<uint16_t>(cells);
+
+        for(int e=0; e < enemyCount; ++e)
+        {
+            const PodState& enemy = enemies[e];
+            std::fill(&hits[0][0][0], &hits[0][0][0] + cells, 0);
+            Vec2 target = checkpoints[enemy.nextCheckpointIdx] - enemy.velocity * 3.0f;
+
+            for(int sample=0; sample < K_OCCUPANCY_SAMPLES; sample += lanes)
+            {
+                FixedPodBatch batch;
+                for(int l=0; l < lanes; ++l) batch.Set(l, enemy);
+
+                for(int turn=0; turn < K_OCCUPANCY_TURNS; ++turn)
+                {
+                    alignas(32) int32_t rotation[lanes], thrust[lanes];
+                    for(int l=0; l < lanes; ++l)
+                    {
+                        rotation[l] = batch.Aim(l, target) + (int32_t)((rng.Uniform() * 2.0f - 1.0f) * noise);
+                        thrust[l] = (enemy.shieldCooldown > turn) ? 0 : (int32_t)(K_MAX_THRUST * (0.5f + 0.5f * rng.Uniform()));
+                    }
+                    batch.Step(rotation, thrust);
+
+                    //a cell counts each sample once even where the neighbourhoods overlap
+                    for(int l=0; l < lanes; ++l)
+                    {
+                        int col = Col(batch.x[l]), row = Row(batch.y[l]);
+                        for(int r=max(row - 1, 0); r <= min(row + 1, K_OCCUPANCY_ROWS - 1); ++r)
+                        {
+                            for(int c=max(col - 1, 0); c <= min(col + 1, K_OCCUPANCY_COLS - 1); ++c) hits[turn][r][c]++;
+                        }
+                    }
+                }
+            }
+
+            //either enemy may be there
+            for(int turn=0; turn < K_OCCUPANCY_TURNS; ++turn)
+            {
+                for(int r=0; r < K_OCCUPANCY_ROWS; ++r)
+                {
+                    for(int c=0; c < K_OCCUPANCY_COLS; ++c)
+                    {
+                        float p = hits[turn][r][c] * (1.0f / K_OCCUPANCY_SAMPLES);
+                        fresh[turn][r][c] = 1.0f - (1.0f - fresh[turn][r][c]) * (1.0f - p);
+                    }
+                }
+            }
+        }
+
+        for(int turn=0; turn < K_OCCUPANCY_TURNS; ++turn)
+        {
+            //last turn's forecast for turn + 1 is the prior for turn now, the farthest turn has none
+            bool hasPrior = primed && turn + 1 < K_OCCUPANCY_TURNS;
+            for(int r=0; r < K_OCCUPANCY_ROWS; ++r)
+            {
+                for(int c=0; c < K_OCCUPANCY_COLS; ++c)
+                {
+                    float prior = hasPrior ? probability[turn+1][r][c] : fresh[turn][r][c];
+                    probability[turn][r][c] = fresh[turn][r][c] * (1.0f - K_OCCUPANCY_DECAY) + prior * K_OCCUPANCY_DECAY;
+                }
+            }
+        }
+        primed = true;
+    }
+};
+
+struct GameState;
+
+#ifdef GOLD_LOCAL
+// Flat Monte Carlo search over variations of the heuristic's first turn action, with sampled
+// enemy behaviour and the rollout policy afterwards. Only the GOLD_LOCAL build has it: with the
+// heuristics alone the bot wins more. It runs threadCount independent searches (root
+// parallelism) and merges their statistics; with a fixed seed, thread count and iteration
+// budget the result is deterministic. Each search thread keeps
+// its rollout state on its own arena, the calling thread on the turn's.
+// The statistics of the previous turn seed the next search, and Allocate spreads a fixed
+// mean budget over the turns by how critical they are.
+struct TurnPlanner
+{
+    uint64_t seed = 1;
+    int threadCount = 1;
+    PlanStats stats = {}; //merged statistics of the last Plan
+    int statsTurn = -1; //turn stats were planned on
+    float bank = 0.0f; //iterations calm turns left for critical ones
+    vector<Arena> arenas; //one per search thread, sized when threadCount changes
+
+    int Allocate(float criticality);
+    void Follow(int turnCount);
+    PlanStats Search(const GameState& gs, const PodAction* base, const PlanStats& prior, uint64_t stream, int iterations, chrono::steady_clock::time_point deadline, Arena& arena) const;
+    void Plan(GameState& gs, int iterations, chrono::steady_clock::time_point deadline);
+};
+
+// Which league policy the enemies play most like. Every turn each policy predicts the enemies'
+// last move from the previous states and our outputs, and keeps a running mean of how far off
+// it was. Also tracks which enemies gave their boost away.
+struct OpponentModel
+{
+    PodState previous[K_TOTAL_SHIPCOUNT];
+    float error[PolicyKindCount] = {};
+    bool boostAvailable[K_TOTAL_SHIPCOUNT];
+    bool primed = false;
+
+    OpponentModel() { std::fill(boostAvailable, boostAvailable + K_TOTAL_SHIPCOUNT, true); }
+
+    //lowest error, ties go to the stronger policy
+    PolicyKind Best() const
+    {
+        int best = PolicyKindCount - 1;
+        for(int k=best - 1; k >= 0; --k)
+        {
+            if(error[k] < error[best]) best = k;
+        }
+        return (PolicyKind)best;
+    }
+
+    void Observe(const GameState& gs);
+};
+#endif
+
+// How often DecideLazy replanned and why, and the time following a plan saved compared to
+// the mean replanning turn.
+struct ReplanCounters
+{
+    int reasons[K_PLAYERCOUNT][ReplanReasonCount] = {};
+    int replanTurns = 0;
+    int lazyTurns = 0;
+    double replanUs = 0.0;
+    double lazyUs = 0.0;
+
+    double SavedUs() const { return (replanTurns > 0) ? lazyTurns * (replanUs / replanTurns) - lazyUs : 0.0; }
+};
+
+struct GameState
+{
+    Vec2 checkpoints[K_MAX_CHECKPOINTS];
+    int checkpointCount;
+    int lapCount;
+
+    RacingLine racingLines[K_MAX_CHECKPOINTS];
+
+    Ship ships[K_TOTAL_SHIPCOUNT];
+
+    bool usedBoost = false;
+    int turnCount = 0;
+    int optimalBoostIdx = 0;
+
+    EnemyOccupancy occupancy; //updated by DecideTurn every turn
+    Arena arena; //per turn scratch, reset by DecideTurn
+    ReplanCounters replans;
+#ifdef GOLD_LOCAL
+    TurnPlanner planner;
+    OpponentModel opponents; //observed by DecideTurn while the planner is on
+#endif
+
+    void ReadVec (Vec2& vec){ int x, y; cin >> x >> y; vec.x = x; vec.y = y; };
+
+    void Initialize()
+    {
+        cin >> lapCount >> checkpointCount;
+        for(int i=0; i < checkpointCount; ++i)
+        {
+            ReadVec(checkpoints[i]);
+        }
+        InitializeTrack();
+    }
+
+    //precomputation once the checkpoints are known
+    void InitializeTrack()
+    {
+        arena.Reserve(K_ARENA_BYTES);
+
+        //all four pods start abreast, the one boost buys the lead into the first checkpoint,
+        //which wins more races than saving it for the longest leg
+        optimalBoostIdx = 1 % checkpointCount;
+
+        OptimizeRacingLines(chrono::steady_clock::now() + chrono::microseconds((int)(K_FIRST_TURN_BUDGET_MS * 1000.0f)));
+    }
+
+    // Follows the stored racing lines: approach the entry of the next checkpoint along its heading,
+    // and once the pod would drift through anyway, start steering for the following line.
+    // Returns the point to fly towards, targetCoord gets inertia compensation on top.
+    Vec2 RacingLineControl(const PodState& pod, Vec2& targetCoord) const
+    {
+        int idx = pod.nextCheckpointIdx;
+        if(WillCoastThrough(pod, checkpoints[idx], racingLines[idx].leadTurns))
+        {
+            idx = (idx+1)%checkpointCount;
+        }
+        return LineAim(pod, idx, targetCoord);
+    }
+
+    //approach along the racing line of checkpoint idx
+    Vec2 LineAim(const PodState& pod, int idx, Vec2& targetCoord) const
+    {
+        const RacingLine& line = racingLines[idx];
+        float dist = (line.entry - pod.pos).Length();
+        Vec2 aim = line.entry - line.heading * std::min(dist * 0.5f, 1500.0f);
+        targetCoord = aim - pod.velocity * 3.0f;
+        return aim;
+    }
+
+    //enemy contacts the occupancy forecast expects while the pod flies K_OCCUPANCY_TURNS turns towards target
+    float ExpectedContact(PodState pod, Vec2 target) const
+    {
+        float contact = 0.0f;
+        for(int turn=0; turn < K_OCCUPANCY_TURNS; ++turn)
+        {
+            SimulateMove(pod, target, RacingThrust(pod, target));
+            contact += occupancy.At(turn, pod.pos);
+            SimulateEndTurn(pod);
+        }
+        return contact;
+    }
+
+    // RacingLineControl for the runner, which keeps to the current checkpoint's line instead of
+    // turning early for the following one when the occupancy forecast expects enemy contact on
+    // the way: a pod knocked while coasting may drift past the checkpoint, one still aiming at
+    // it steers back.
+    Vec2 ContestedRacingLineControl(const PodState& pod, Vec2& targetCoord) const
+    {
+        int idx = pod.nextCheckpointIdx;
+        Vec2 aim = RacingLineControl(pod, targetCoord);
+        if(!WillCoastThrough(pod, checkpoints[idx], racingLines[idx].leadTurns)) return aim;
+        if(ExpectedContact(pod, targetCoord) < K_CONTESTED_CONTACT) return aim;
+        return LineAim(pod, idx, targetCoord);
+    }
+
+#ifdef GOLD_LOCAL
+    PolicyOutput EvaluatePolicy(const PodState& pod) const
+    {
+        alignas(32) float features[K_NET_INPUTS];
+        PolicyFeatures(pod, checkpoints[pod.nextCheckpointIdx], checkpoints[(pod.nextCheckpointIdx+1)%checkpointCount], features);
+        return RunPolicyNet(features);
+    }
+#endif
+
+    //turns needed to fly from the previous checkpoint through idx and reach the one after it, using the current lines
+    float SimulateLegTime(int idx) const
+    {
+        constexpr int maxTurns = 100;
+        constexpr float startSpeed = 400.0f;
+
+        int prev = (idx + checkpointCount - 1) % checkpointCount;
+        Vec2 legDir = (checkpoints[idx] - checkpoints[prev]).Normalized();
+
+        PodState pod = {checkpoints[prev], legDir * startSpeed, NormalizeAngle(legDir.ToAngle() * K_RAD_TO_DEG), idx, 0};
+        for(int turn=1; turn <= maxTurns; ++turn)
+        {
+            Vec2 targetCoord;
+            RacingLineControl(pod, targetCoord);
+
+            Vec2 from = pod.pos;
+            SimulateMove(pod, targetCoord, RacingThrust(pod, targetCoord));
+            if(SegmentHitsCircle(from, pod.pos, checkpoints[pod.nextCheckpointIdx], K_CHECKPOINT_RADIUS))
+            {
+                if(++pod.checkpointsPassedCount == 2)
+                {
+                    //prefer leaving the leg with the most speed
+                    return turn - pod.velocity.Length() * 1e-4f;
+                }
+                pod.nextCheckpointIdx = (pod.nextCheckpointIdx+1)%checkpointCount;
+            }
+            SimulateEndTurn(pod);
+        }
+        return (float)maxTurns;
+    }
+
+    //turns a lone runner needs for the whole race from a standing start, using the current lines; stops past bound
+    float SimulateRaceTime(float bound) const
+    {
+        constexpr int maxLegTurns = 60;
+
+        int finish = lapCount * checkpointCount;
+        PodState pod = {checkpoints[0], {0.0f, 0.0f}, -1.0f, 1 % checkpointCount, 0};
+        for(int turn=1; turn <= finish * maxLegTurns; ++turn)
+        {
+            if(turn > bound + 1.0f) return bound + 1.0f;
+
+            Vec2 targetCoord;
+            RacingLineControl(pod, targetCoord);
+            Vec2 from = pod.pos;
+            SimulateMove(pod, targetCoord, RacingThrust(pod, targetCoord));
+            if(SegmentHitsCircle(from, pod.pos, checkpoints[pod.nextCheckpointIdx], K_CHECKPOINT_RADIUS))
+            {
+                if(++pod.checkpointsPassedCount == finish) return turn - pod.velocity.Length() * 1e-4f;
+                pod.nextCheckpointIdx = (pod.nextCheckpointIdx+1)%checkpointCount;
+            }
+            SimulateEndTurn(pod);
+        }
+        return (float)(finish * maxLegTurns);
+    }
+
+    // Searches per checkpoint for the crossing point, approach heading and turn-in timing.
+    // The first sweep minimizes the simulated time of the two legs using the line, which is
+    // cheap but starts every leg at the same speed. The second adds the time of the whole
+    // race, so a line also pays for the speed and heading it leaves for the checkpoints after
+    // it. The leg times stay in, weighted by legWeight: the whole race alone picks lines that
+    // only work from the exact simulated approach, and a knocked runner then misses them.
+    void OptimizeRacingLines(chrono::steady_clock::time_point deadline)
+    {
+        constexpr int legSweeps = 1;
+        constexpr int sweeps = legSweeps + 1;
+        constexpr float legWeight = 16.0f;
+        constexpr int entryAngles = 12;
+        constexpr float entryRadii[] = {200.0f, 400.0f};
+        constexpr float headingDeviations[] = {-40.0f, -20.0f, 0.0f, 20.0f, 40.0f};
+        constexpr int leadTurns[] = {0, 2, 4, 6};
+
+        for(int i=0; i < checkpointCount; ++i)
+        {
+            Vec2 prev = checkpoints[(i + checkpointCount - 1) % checkpointCount];
+            racingLines[i] = {checkpoints[i], (checkpoints[i] - prev).Normalized(), 0};
+        }
+
+        for(int sweep=0; sweep < sweeps; ++sweep)
+        {
+            for(int i=0; i < checkpointCount; ++i)
+            {
+                if(chrono::steady_clock::now() > deadline) return;
+
+                RacingLine best = racingLines[i];
+                int before = (i + checkpointCount - 1) % checkpointCount;
+                bool wholeRace = sweep >= legSweeps;
+                float bestTime = INFINITY; //no bound on timing the current line
+                auto LinesTime = [&]()
+                {
+                    float legs = SimulateLegTime(before) + SimulateLegTime(i);
+                    if(!wholeRace) return legs;
+                    return SimulateRaceTime(bestTime - legWeight * legs) + legWeight * legs;
+                };
+                bestTime = LinesTime();
+                float legAngle = (checkpoints[i] - checkpoints[before]).ToAngle() * K_RAD_TO_DEG;
+
+                for(int a=0; a <= entryAngles * 2; ++a)
+                {
+                    //a == 0 is the checkpoint center, the rest walk the rings
+                    Vec2 entry = checkpoints[i];
+                    if(a > 0) entry = entry + AngleToDir(360.0f * (a-1) / entryAngles) * entryRadii[(a-1) / entryAngles];
+
+                    for(float deviation : headingDeviations)
+                    {
+                        for(int lead : leadTurns)
+                        {
+                            racingLines[i] = {entry, AngleToDir(legAngle + deviation), lead};
+                            float time = LinesTime();
+                            if(time < bestTime)
+                            {
+                                bestTime = time;
+                                best = racingLines[i];
+                            }
+                        }
+                    }
+                }
+                racingLines[i] = best;
+            }
+        }
+    }
+
+    void ReadInput()
+    {
+        for(int i=0; i < K_TOTAL_SHIPCOUNT; ++i)
+        {
+            Vec2 pos, velocity;
+            float angle;
+            int checkpointIdx;
+            ReadVec(pos);
+            ReadVec(velocity);
+            cin >> angle >> checkpointIdx;
+            UpdateShip(i, pos, velocity, angle, checkpointIdx);
+        }
+    }
+
+    //one pod's line of turn input, also how local harnesses feed the bot without text
+    void UpdateShip(int idx, Vec2 pos, Vec2 velocity, float angle, int checkpointIdx)
+    {
+        Ship& ship = ships[idx];
+        ship.pos = pos;
+        ship.velocity = velocity;
+        ship.angle = angle;
+        if(checkpointIdx != ship.nextCheckpointIdx)
+        {
+            ship.nextCheckpointIdx = checkpointIdx;
+            ship.checkpointsPassedCount++;
+        }
+        ship.nextCheckpointAngle = (checkpoints[ship.nextCheckpointIdx] - ship.pos).ToAngle() * K_RAD_TO_DEG;
+        ship.isPlayer = (idx < K_PLAYERCOUNT);
+        ship.id = idx;
+    }
+
+    Ship& Player(int idx) { return ships[idx]; }
+    Ship& Enemy(int idx) { return ships[idx + K_PLAYERCOUNT]; }
+
+    const Ship& FindBestEnemy() const
+    {
+        float shipScore = 1e+8f * -1.0f;
+        const Ship* pShip = nullptr;
+        for(int i=0; i < K_ENEMYCOUNT; ++i)
+        {
+            const Ship& enemy = ships[i + K_PLAYERCOUNT];
+            float score = enemy.checkpointsPassedCount * K_CHECKPOINT_PROGRESS - (checkpoints[enemy.nextCheckpointIdx] - enemy.pos).Length();
+            if(score > shipScore)
+            {
+                shipScore = score;
+                pShip = &enemy;
+            }
+        }
+        return *pShip;
+    }
+};
+
+//eases off next to dest to avoid overshooting, and while not moving towards it
+float BumpThrust(const PodState& pod, Vec2 dest)
+{
+    Vec2 direction = dest - pod.pos;
+    float dist = direction.Length();
+    float thrust = K_MAX_THRUST;
+
+    thrust *= clamp01(dist / (K_CHECKPOINT_RADIUS * 2.0f)); //slow down next to checkpoints to avoid overshooting
+
+    //fine steering when not facing away from point
+    float dot = direction.Normalized().Dot(pod.velocity.Normalized());
+    if(dot > 0.0f)
+    {
+        thrust *= clamp01(dot);
+    }
+    return thrust;
+}
+
+// The bumper's heuristic on plain pod states, so plans can look ahead with it: cut in halfway
+// between the leading enemy and its checkpoint, accounting for inertia.
+PodAction BumpAction(const GameState& gs, const PodState& pod, const PodState& enemy, Vec2& dest)
+{
+    Vec2 point = lerp(enemy.pos, gs.checkpoints[enemy.nextCheckpointIdx], 0.5f);
+    Vec2 diff = (pod.pos - point);
+    dest = point + diff.Normalized() * 100.0f;
+
+    float approach = clamp01(diff.Length() / (K_CHECKPOINT_RADIUS * 2.0f));
+    PodAction action;
+    action.target = dest - pod.velocity * 2.75f * approach;
+    action.thrust = BumpThrust(pod, dest);
+    return action;
+}
+
+void EvaluateTargetCoord(GameState& gs, Ship& ship)
+{
+    if(ship.command == Command::BumpStrongestEnemy)
+    {
+        ship.targetCoord = BumpAction(gs, ship.State(), gs.FindBestEnemy().State(), ship.dest).target;
+        return;
+    }
+
+#ifdef GOLD_LOCAL
+    if(K_USE_NEURAL_POLICY)
+    {
+        Vec2 point = gs.checkpoints[ship.nextCheckpointIdx];
+        PolicyOutput policy = gs.EvaluatePolicy(ship.State());
+        float heading = (ship.angle < 0.0f) ? (point - ship.pos).ToAngle() * K_RAD_TO_DEG : ship.angle + policy.rotation;
+        ship.dest = ship.pos + AngleToDir(heading) * K_CHECKPOINT_RADIUS;
+        ship.targetCoord = ship.pos + AngleToDir(heading) * 10000.0f;
+        ship.thrust = policy.thrust;
+        return;
+    }
+#endif
+
+    //the racing lines already account for inertia and the next leg
+    ship.dest = gs.ContestedRacingLineControl(ship.State(), ship.targetCoord);
+}
+
+//outputs the desired travel direction and thrust value
+void EvaluateThrust(GameState& gs, Ship& ship)
+{
+    if(ship.command == Command::SeekCheckpoint)
+    {
+#ifdef GOLD_LOCAL
+        //the neural policy already picked its thrust
+        if(K_USE_NEURAL_POLICY) return;
+#endif
+        ship.thrust = RacingThrust(ship.State(), ship.targetCoord);
+        return;
+    }
+
+    ship.thrust = BumpThrust(ship.State(), ship.dest);
+}
+
+//the one boost goes to the boost leg, once the pod is lined up for it
+BoostReason RacingBoost(const GameState& gs, const PodState& pod, const PodAction& action, bool available)
+{
+    Vec2 checkpoint = gs.checkpoints[pod.nextCheckpointIdx];
+    bool onBoostLeg = pod.nextCheckpointIdx == gs.optimalBoostIdx && (checkpoint - pod.pos).Length() > 3000.0f;
+    bool isAligned = pod.angle < 0.0f || abs(AngleDiff(pod.angle, (action.target - pod.pos).ToAngle() * K_RAD_TO_DEG)) < 10.0f;
+
+    bool fullThrust = action.thrust >= K_MAX_THRUST * 0.95f;
+
+    return !available ? BoostSpent : !onBoostLeg ? BoostWrongLeg : !isAligned ? BoostNotAligned : !fullThrust ? BoostLowThrust : BoostFired;
+}
+
+// When catching a long road to the next checkpoint, why not also boost?
+void EvaluateShouldBoost(GameState& gs, Ship& ship)
+{
+    if(ship.command != Command::SeekCheckpoint)
+    {
+        ship.doBoost = false;
+        ship.boostReason = BoostNotRunner;
+        return;
+    }
+
+    ship.boostReason = RacingBoost(gs, ship.State(), {ship.targetCoord, ship.thrust}, !gs.usedBoost);
+    ship.doBoost = ship.boostReason == BoostFired;
+    gs.usedBoost = gs.usedBoost || ship.doBoost;
+}
+
+//how far along the race a pod is, one checkpoint is worth K_CHECKPOINT_PROGRESS
+float RaceProgress(const GameState& gs, const PodState& pod)
+{
+    return pod.checkpointsPassedCount * K_CHECKPOINT_PROGRESS - (gs.checkpoints[pod.nextCheckpointIdx] - pod.pos).Length();
+}
+
+//our best pod's lead over the best enemy pod
+float TeamProgress(const GameState& gs, const PodState* pods)
+{
+    float ours = max(RaceProgress(gs, pods[0]), RaceProgress(gs, pods[1]));
+    float theirs = max(RaceProgress(gs, pods[K_PLAYERCOUNT]), RaceProgress(gs, pods[K_PLAYERCOUNT+1]));
+    return ours - theirs;
+}
+
+// Cheap stand-in for everybody's decisions after the current turn: the runner follows its
+// racing line, the bumper rams the leading enemy, enemies fly at their checkpoint.
+void RolloutActions(const GameState& gs, const PodState* pods, PodAction* actions)
+{
+    int leader = (RaceProgress(gs, pods[K_PLAYERCOUNT]) >= RaceProgress(gs, pods[K_PLAYERCOUNT+1])) ? K_PLAYERCOUNT : K_PLAYERCOUNT+1;
+    for(int i=0; i < K_TOTAL_SHIPCOUNT; ++i)
+    {
+        const PodState& pod = pods[i];
+        PodAction& action = actions[i];
+        if(i < K_PLAYERCOUNT && gs.ships[i].command == Command::SeekCheckpoint)
+        {
+            gs.RacingLineControl(pod, action.target);
+            action.thrust = RacingThrust(pod, action.target);
+        }
+        else if(i < K_PLAYERCOUNT)
+        {
+            action.target = pods[leader].pos + pods[leader].velocity;
+            action.thrust = K_MAX_THRUST;
+        }
+        else
+        {
+            action.target = gs.checkpoints[pod.nextCheckpointIdx] - pod.velocity * 3.0f;
+            action.thrust = K_MAX_THRUST;
+        }
+        action.shield = false;
+        action.boost = false;
+    }
+}
+
+//signed angle between the pod's facing and its checkpoint, as the single pod leagues gave it
+float CheckpointAngle(const PodState& pod, Vec2 checkpoint)
+{
+    if(pod.angle < 0.0f) return 0.0f;
+    return AngleDiff(pod.angle, (checkpoint - pod.pos).ToAngle() * K_RAD_TO_DEG);
+}
+
+// wood2.cpp: full thrust at the checkpoint unless it is behind
+PodAction Wood2Policy(const PodState& pod, Vec2 checkpoint)
+{
+    float thrust = (abs(CheckpointAngle(pod, checkpoint)) > 90.0f) ? 0.0f : K_MAX_THRUST;
+    return {checkpoint, thrust};
+}
+
+// wood1.cpp: wood2 plus the one boost on a long straight
+PodAction Wood1Policy(const PodState& pod, Vec2 checkpoint)
+{
+    PodAction action = Wood2Policy(pod, checkpoint);
+    action.boost = pod.boostAvailable && (checkpoint - pod.pos).Length() > 3000.0f && action.thrust >= K_MAX_THRUST * 0.95f;
+    return action;
+}
+
+// bronze.cpp: no thrust while facing away, slow down within 1000 units
+PodAction BronzePolicy(const PodState& pod, Vec2 checkpoint)
+{
+    Vec2 diff = checkpoint - pod.pos;
+    Vec2 forward = (pod.angle < 0.0f) ? diff.Normalized() : AngleToDir(pod.angle);
+    float angleMultiplier = (forward.Dot(diff.Normalized()) > 0.0f) ? 1.0f : 0.0f;
+    float distanceMultiplier = clamp01(diff.Length() / 1000.0f);
+
+    PodAction action = {checkpoint, (float)(int)(K_MAX_THRUST * angleMultiplier * distanceMultiplier)};
+    action.boost = pod.boostAvailable && diff.Length() > 3000.0f && action.thrust >= K_MAX_THRUST * 0.95f;
+    return action;
+}
+
+// silver.cpp: aim at the near edge of the checkpoint with inertia compensation,
+// shield against the closest opponent on a bad impact angle
+PodAction SilverPolicy(const PodState& pod, Vec2 checkpoint, const PodState& opponent)
+{
+    Vec2 dest = checkpoint + (pod.pos - checkpoint).Normalized() * 250.0f;
+    Vec2 direction = dest - pod.pos;
+    float angle = CheckpointAngle(pod, checkpoint);
+    float dist = (checkpoint - pod.pos).Length();
+
+    float thrust = K_MAX_THRUST * clamp01(direction.Length() / (K_CHECKPOINT_RADIUS * 2.0f));
+    if(direction.Normalized().Dot(pod.velocity) > 0.0f)
+    {
+        thrust *= clamp01(1.0f - abs(angle) / 90.0f);
+    }
+
+    PodAction action = {dest - pod.velocity * 2.75f, thrust};
+    bool opponentIsClose = (pod.pos - opponent.pos).Length() <= K_POD_RADIUS * 2.1f;
+    bool impactAngleIsBad = pod.velocity.Normalized().Dot(opponent.velocity.Normalized()) <= 0.25f;
+    action.shield = opponentIsClose && impactAngleIsBad;
+    action.boost = !action.shield && pod.boostAvailable && dist > 3000.0f && angle <= 10.0f;
+    return action;
+}
+
+//runs rule(pod, member) for every member of one team
+template<typename Rule>
+void ForTeam(int team, PodAction* actions, Rule rule)
+{
+    for(int m=0; m < K_PLAYERCOUNT; ++m) actions[m] = rule(team * K_PLAYERCOUNT + m, m);
+}
+
+// The policy zoo: what a league bot would send for one team of a race state, K_TOTAL_SHIPCOUNT
+// pods in, K_PLAYERCOUNT actions out. Pure functions of the pod states, a rule may only boost
+// a pod whose boostAvailable is still set. Gold plays its heuristics, the first team member
+// racing and the second bumping.
+void PolicyActions(PolicyKind kind, const GameState& gs, const PodState* pods, int team, PodAction* actions)
+{
+    auto Checkpoint = [&](const PodState& pod) { return gs.checkpoints[pod.nextCheckpointIdx]; };
+    int opponents = (1 - team) * K_PLAYERCOUNT;
+    switch(kind)
+    {
+        case PolicyWood2:
+            ForTeam(team, actions, [&](int i, int) { return Wood2Policy(pods[i], Checkpoint(pods[i])); });
+            break;
+        case PolicyWood1:
+            ForTeam(team, actions, [&](int i, int) { return Wood1Policy(pods[i], Checkpoint(pods[i])); });
+            break;
+        case PolicyBronze:
+            ForTeam(team, actions, [&](int i, int) { return BronzePolicy(pods[i], Checkpoint(pods[i])); });
+            break;
+        case PolicySilver:
+            ForTeam(team, actions, [&](int i, int)
+            {
+                const PodState* opponent = pods + opponents;
+                bool first = (opponent[0].pos - pods[i].pos).Length() < (opponent[1].pos - pods[i].pos).Length();
+                return SilverPolicy(pods[i], Checkpoint(pods[i]), first ? opponent[0] : opponent[1]);
+            });
+            break;
+        default:
+            ForTeam(team, actions, [&](int i, int member)
+            {
+                PodAction action;
+                if(member == 0)
+                {
+                    gs.RacingLineControl(pods[i], action.target);
+                    action.thrust = RacingThrust(pods[i], action.target);
+                    action.boost = RacingBoost(gs, pods[i], action, pods[i].boostAvailable) == BoostFired;
+                    return action;
+                }
+                const PodState* opponent = pods + opponents;
+                const PodState& leader = (RaceProgress(gs, opponent[0]) >= RaceProgress(gs, opponent[1])) ? opponent[0] : opponent[1];
+                Vec2 dest;
+                return BumpAction(gs, pods[i], leader, dest);
+            });
+            break;
+    }
+}
+
+#ifdef GOLD_LOCAL
+// Called at the start of a turn, while the ships still hold the outputs we sent for the
+// previous states.
+void OpponentModel::Observe(const GameState& gs)
 {
-    // inputs
-    Vec2 pos;
-    Vec2 velocity;
-    float angle;
-    int nextCheckpointIdx;
-    int checkpointsPassedCount = 0;
+    if(primed)
+    {
+        for(int i=K_PLAYERCOUNT; i < K_TOTAL_SHIPCOUNT; ++i)
+        {
+            Vec2 accel = gs.ships[i].velocity - previous[i].velocity * K_FRICTION;
+            if(accel.Length() > K_MAX_THRUST + K_OPPONENT_BOOST_ACCEL) boostAvailable[i] = false;
+        }
 
-    //helper vars
-    int id;
-    bool isPlayer;
-    float nextCheckpointAngle; //degrees
-    Vec2 dest;
+        for(int k=0; k < PolicyKindCount; ++k)
+        {
+            PodState pods[K_TOTAL_SHIPCOUNT];
+            PodAction actions[K_TOTAL_SHIPCOUNT];
+            std::copy(previous, previous + K_TOTAL_SHIPCOUNT, pods);
+            for(int i=0; i < K_PLAYERCOUNT; ++i) actions[i] = gs.ships[i].Action();
+            PolicyActions((PolicyKind)k, gs, pods, 1, actions + K_PLAYERCOUNT);
+            SimulateTurn(pods, actions, K_TOTAL_SHIPCOUNT, gs.checkpoints, gs.checkpointCount);
 
-    //simulation specific
-    Command command = Command::SeekCheckpoint;
+            float miss = 0.0f;
+            for(int i=K_PLAYERCOUNT; i < K_TOTAL_SHIPCOUNT; ++i) miss += (pods[i].pos - gs.ships[i].pos).Length();
+            error[k] += (miss - error[k]) * K_OPPONENT_ERROR_DECAY;
+        }
+    }
 
-    //outputs
-    Vec2 targetCoord;
-    float thrust;
-    bool doShield;
-    bool doBoost;
+    for(int i=0; i < K_TOTAL_SHIPCOUNT; ++i)
+    {
+        previous[i] = gs.ships[i].State();
+        previous[i].boostAvailable = boostAvailable[i] && (i >= K_PLAYERCOUNT || !gs.usedBoost);
+    }
+    primed = true;
+}
+#endif
+
+//whether another pod could touch this one during the current turn
+bool IsThreatened(const GameState& gs, const Ship& ship)
+{
+    constexpr float impactDistTolerance = K_POD_RADIUS * 2.0f;
+    for(int i=0; i < K_TOTAL_SHIPCOUNT; ++i)
+    {
+        const Ship& other = gs.ships[i];
+        if(other.id == ship.id) continue;
+
+        bool otherIsClose = (ship.pos - other.pos).Length() <= impactDistTolerance;
+        bool willImpact = ((ship.pos + ship.velocity) - (other.pos + other.velocity)).Length() <= impactDistTolerance;
+        if(otherIsClose || willImpact) return true;
+    }
+    return false;
+}
+
+//one line of play in EvaluateShouldShield, shielded is the player pod that shields at once or -1
+struct ShieldRollout
+{
+    PodState pods[K_TOTAL_SHIPCOUNT];
+    PodAction actions[K_TOTAL_SHIPCOUNT];
+    int shielded;
 };
 
-struct GameState
+// Weighs SHIELD for every threatened player pod by simulating the next K_SHIELD_LOOKAHEAD turns
+// with and without it: the extra mass in this turn's collisions against the thrust lost while
+// the shield cools down. All candidates share one baseline rollout and step together.
+void EvaluateShouldShield(GameState& gs)
 {
-    Vec2 checkpoints[K_MAX_CHECKPOINTS];
-    int checkpointCount;
-    int lapCount;
+    FixedArray<ShieldRollout> rollouts = gs.arena.Array<ShieldRollout>(K_PLAYERCOUNT + 1);
+    rollouts.Push({})->shielded = -1;
 
-    Ship ships[K_TOTAL_SHIPCOUNT];
+    for(int i=0; i < K_PLAYERCOUNT; ++i)
+    {
+        gs.Player(i).doShield = false;
+        gs.Player(i).shieldReason = ShieldNotThreatened;
+        gs.Player(i).shieldGain = 0.0f;
+        if(IsThreatened(gs, gs.Player(i))) rollouts.Push({})->shielded = i;
+    }
+    if(rollouts.count == 1) return;
 
-    bool usedBoost;
-    int turnCount = 0;
-    int optimalBoostIdx = 0;
+    for(ShieldRollout& r : rollouts)
+    {
+        for(int i=0; i < K_TOTAL_SHIPCOUNT; ++i) r.pods[i] = gs.ships[i].State();
+        RolloutActions(gs, r.pods, r.actions);
+        for(int i=0; i < K_PLAYERCOUNT; ++i) r.actions[i] = gs.Player(i).Action();
+        if(r.shielded >= 0) r.actions[r.shielded].shield = true;
+    }
 
-    void ReadVec (Vec2& vec){ int x, y; cin >> x >> y; vec.x = x; vec.y = y; };
+    for(int turn=0; turn < K_SHIELD_LOOKAHEAD; ++turn)
+    {
+        for(ShieldRollout& r : rollouts)
+        {
+            if(turn > 0) RolloutActions(gs, r.pods, r.actions);
+            SimulateTurn(r.pods, r.actions, K_TOTAL_SHIPCOUNT, gs.checkpoints, gs.checkpointCount);
+        }
+    }
 
-    void Initialize()
+    float baseline = TeamProgress(gs, rollouts[0].pods);
+    for(int r=1; r < rollouts.count; ++r)
     {
-        cin >> lapCount >> checkpointCount;
-        for(int i=0; i < checkpointCount; ++i)
+        Ship& ship = gs.Player(rollouts[r].shielded);
+        ship.shieldGain = TeamProgress(gs, rollouts[r].pods) - baseline;
+        ship.doShield = ship.shieldGain > 0.0f;
+        ship.shieldReason = ship.doShield ? ShieldGain : ShieldNoGain;
+    }
+}
+
+#ifdef GOLD_LOCAL
+//one of the K_PLAN_MOVES variations of a heuristic action: as is, steered off by up to a full
+//rotation either way, coasting, half thrust, or shielding
+PodAction PlanMove(const PodState& pod, PodAction action, int move)
+{
+    constexpr float turnOffsets[] = {0.0f, -K_MAX_ROTATION_DEG, -K_MAX_ROTATION_DEG * 0.5f, K_MAX_ROTATION_DEG * 0.5f, K_MAX_ROTATION_DEG};
+    if(move < 5)
+    {
+        action.target = pod.pos + (action.target - pod.pos).Rotate(turnOffsets[move] * K_DEG_TO_RAD);
+        return action;
+    }
+
+    action.boost = false;
+    action.shield = (move == 7);
+    action.thrust = (move == 6) ? action.thrust * 0.5f : 0.0f;
+    return action;
+}
+
+// How much this turn's decision matters, from 0 on a clear straight to 1: the runner about
+// to reach its checkpoint, a player pod heading into likely enemy contact, or one that still
+// has to turn a long way towards its target.
+float TurnCriticality(const GameState& gs)
+{
+    float criticality = 0.0f;
+    for(int i=0; i < K_PLAYERCOUNT; ++i)
+    {
+        const Ship& ship = gs.ships[i];
+        if(i == 0)
         {
-            ReadVec(checkpoints[i]);
+            float edge = (gs.checkpoints[ship.nextCheckpointIdx] - ship.pos).Length() - K_CHECKPOINT_RADIUS;
+            criticality = max(criticality, 1.0f - clamp01(edge / K_CRITICAL_CHECKPOINT_DIST));
         }
 
-        float bestDist = -1.0f;
-        for(int i=0; i < checkpointCount; ++i)
+        float contact = 0.0f;
+        for(int turn=0; turn < K_OCCUPANCY_TURNS; ++turn) contact += gs.occupancy.At(turn, ship.pos + ship.velocity * (float)(turn + 1));
+        criticality = max(criticality, clamp01(contact));
+
+        //the first turn's heading is free, the referee reports -1 for it
+        if(ship.angle >= 0.0f)
         {
-            Vec2 next = checkpoints[(i+1)%checkpointCount];
-            float dist = (next - checkpoints[i]).Length();
-            if(dist > bestDist)
-            {
-                bestDist = dist;
-                optimalBoostIdx = (i+1)%checkpointCount;
-            }
+            float heading = abs(AngleDiff(ship.angle, (ship.targetCoord - ship.pos).ToAngle() * K_RAD_TO_DEG));
+            criticality = max(criticality, heading / 180.0f);
         }
     }
+    return criticality;
+}
 
-    void ReadInput()
+// Iterations for a turn of the given criticality. Every turn earns K_PLAN_ITERATIONS; calm
+// turns spend a fraction of it and bank the rest for critical ones, so the mean never grows.
+int TurnPlanner::Allocate(float criticality)
+{
+    bank = min(bank + K_PLAN_ITERATIONS, K_PLAN_ITERATIONS * K_PLAN_BANK_TURNS);
+    float share = K_PLAN_MIN_SHARE + (K_PLAN_MAX_SHARE - K_PLAN_MIN_SHARE) * criticality;
+    int iterations = (int)min(bank, K_PLAN_ITERATIONS * share);
+    bank -= iterations;
+    return iterations;
+}
+
+// A lazy turn follows the last plan without searching. It banks its whole share, and the
+// statistics of that plan stay the prior of the next search instead of going stale.
+void TurnPlanner::Follow(int turnCount)
+{
+    bank = min(bank + K_PLAN_ITERATIONS, K_PLAN_ITERATIONS * K_PLAN_BANK_TURNS);
+    statsTurn = turnCount;
+}
+
+PlanStats TurnPlanner::Search(const GameState& gs, const PodAction* base, const PlanStats& prior, uint64_t stream, int iterations, chrono::steady_clock::time_point deadline, Arena& arena) const
+{
+    PlanStats result = {};
+    PlanRng rng = {stream};
+    PodState* start = arena.New<PodState>(K_TOTAL_SHIPCOUNT);
+    PodState* pods = arena.New<PodState>(K_TOTAL_SHIPCOUNT);
+    PodAction* actions = arena.New<PodAction>(K_TOTAL_SHIPCOUNT);
+    for(int i=0; i < K_TOTAL_SHIPCOUNT; ++i) start[i] = gs.ships[i].State();
+    for(int i=K_PLAYERCOUNT; i < K_TOTAL_SHIPCOUNT; ++i) start[i].boostAvailable = gs.opponents.boostAvailable[i];
+    PolicyKind policy = gs.opponents.Best();
+    int priorVisits = 0;
+    for(int a=0; a < K_PLAN_ARMS; ++a) priorVisits += prior.visits[a];
+    float rootProgress = TeamProgress(gs, start); //scores are gains over it, so they stay comparable across turns
+
+    for(int it=0; it < iterations; ++it)
     {
-        auto ReadShip = [&](Ship& ship)
+        if((it & 63) == 0 && chrono::steady_clock::now() > deadline) break;
+
+        //every arm once, then UCB1 over the prior and this search together
+        int arm = it;
+        if(it >= K_PLAN_ARMS || prior.visits[it] > 0)
         {
-            ReadVec(ship.pos);
-            ReadVec(ship.velocity);
-            int checkpointIdx;
-            cin >> ship.angle >> checkpointIdx;
-            if(checkpointIdx != ship.nextCheckpointIdx)
+            float bestUcb = -1e+30f;
+            float logVisits = log((float)(it + priorVisits));
+            for(int a=0; a < K_PLAN_ARMS; ++a)
             {
-                ship.nextCheckpointIdx = checkpointIdx;
-                ship.checkpointsPassedCount++;
+                int visits = prior.visits[a] + result.visits[a];
+                if(visits == 0)
+                {
+                    arm = a;
+                    break;
+                }
+                float ucb = (prior.score[a] + result.score[a]) / visits + K_PLAN_EXPLORATION * sqrt(logVisits / visits);
+                if(ucb > bestUcb)
+                {
+                    bestUcb = ucb;
+                    arm = a;
+                }
             }
-            ship.nextCheckpointAngle = (checkpoints[ship.nextCheckpointIdx] - ship.pos).ToAngle() * K_RAD_TO_DEG;
-        };
+        }
 
-        for(int i=0; i < K_TOTAL_SHIPCOUNT; ++i)
+        std::copy(start, start + K_TOTAL_SHIPCOUNT, pods);
+        float contact = 0.0f; //expected enemy contacts along the runner's path
+        for(int turn=0; turn < K_PLAN_DEPTH; ++turn)
         {
-            ReadShip(ships[i]);
-            ships[i].isPlayer = (i < K_PLAYERCOUNT);
-            ships[i].id = i;
+            RolloutActions(gs, pods, actions);
+            if(K_PLAN_OPPONENT_POLICY) PolicyActions(policy, gs, pods, 1, actions + K_PLAYERCOUNT);
+            if(turn == 0)
+            {
+                actions[0] = PlanMove(pods[0], base[0], arm / K_PLAN_MOVES);
+                actions[1] = PlanMove(pods[1], base[1], arm % K_PLAN_MOVES);
+            }
+            for(int i=K_PLAYERCOUNT; i < K_TOTAL_SHIPCOUNT; ++i)
+            {
+                float offset = (rng.Uniform() * 2.0f - 1.0f) * K_PLAN_ENEMY_NOISE_DEG * K_DEG_TO_RAD;
+                actions[i].target = pods[i].pos + (actions[i].target - pods[i].pos).Rotate(offset);
+                actions[i].thrust *= 0.5f + 0.5f * rng.Uniform();
+            }
+            SimulateTurn(pods, actions, K_TOTAL_SHIPCOUNT, gs.checkpoints, gs.checkpointCount);
+            if(turn < K_OCCUPANCY_TURNS) contact += gs.occupancy.At(turn, pods[0].pos);
         }
+
+        result.visits[arm]++;
+        result.score[arm] += TeamProgress(gs, pods) - rootProgress - contact * K_PLAN_CONTACT_PENALTY;
     }
+    return result;
+}
 
-    Ship& Player(int idx) { return ships[idx]; }
-    Ship& Enemy(int idx) { return ships[idx + K_PLAYERCOUNT]; }
+// Persistent workers for the local build. Run hands job i to worker i and waits for all of them.
+struct ThreadPool
+{
+    vector<thread> workers;
+    mutex lock;
+    condition_variable wake;
+    condition_variable done;
+    void (*job)(void*, int) = nullptr; //type erased task without std::function's allocation
+    void* task = nullptr;
+    uint64_t generation = 0;
+    int pending = 0;
+    bool stopping = false;
 
-    Ship& FindBestEnemy()
+    explicit ThreadPool(int count)
+    {
+        for(int i=0; i < count; ++i) workers.emplace_back([this, i]() { Work(i); });
+    }
+
+    ~ThreadPool()
     {
-        float shipScore = 1e+8f * -1.0f;
-        Ship* pShip = nullptr;
-        for(int i=0; i < K_ENEMYCOUNT; ++i)
         {
-            Ship& enemy = Enemy(i);
-            float score = enemy.checkpointsPassedCount * 20000.0f - (checkpoints[enemy.nextCheckpointIdx] - enemy.pos).Length();
-            if(score > shipScore)
-            {
-                shipScore = score;
-                pShip = &enemy;
-            }
+            lock_guard<mutex> guard(lock);
+            stopping = true;
+        }
+        wake.notify_all();
+        for(thread& worker : workers) worker.join();
+    }
+
+    void Work(int idx)
+    {
+        uint64_t seen = 0;
+        unique_lock<mutex> guard(lock);
+        for(;;)
+        {
+            wake.wait(guard, [&]() { return stopping || generation != seen; });
+            if(stopping) return;
+            seen = generation;
+
+            guard.unlock();
+            job(task, idx);
+            guard.lock();
+            if(--pending == 0) done.notify_one();
         }
-        return *pShip;
+    }
+
+    template<typename Task>
+    void Run(Task& work)
+    {
+        unique_lock<mutex> guard(lock);
+        job = [](void* t, int idx) { (*(Task*)t)(idx); };
+        task = &work;
+        pending = (int)workers.size();
+        generation++;
+        wake.notify_all();
+        done.wait(guard, [&]() { return pending == 0; });
     }
 };
 
-void EvaluateTargetCoord(GameState& gs, Ship& ship)
+//one pool shared by every planner, rebuilt when the thread count changes
+ThreadPool& PlannerPool(int threads)
 {
-    Vec2 point = gs.checkpoints[ship.nextCheckpointIdx];
-    float radius = 200.0f;
-    float velocityLength = ship.velocity.Length();
+    static unique_ptr<ThreadPool> pool;
+    if(!pool || (int)pool->workers.size() != threads) pool = make_unique<ThreadPool>(threads);
+    return *pool;
+}
 
-    if(ship.command == Command::BumpStrongestEnemy)
+// Replaces both player pods' outputs with the best planned variation of what the heuristics
+// chose. iterations is the budget of each search thread. A plan made on the previous turn is
+// reused as a decayed prior, so a short search on a calm turn mostly confirms it.
+void TurnPlanner::Plan(GameState& gs, int iterations, chrono::steady_clock::time_point deadline)
+{
+    PodAction base[K_PLAYERCOUNT];
+    for(int i=0; i < K_PLAYERCOUNT; ++i) base[i] = gs.Player(i).Action();
+    PlanStats prior = (statsTurn >= 0 && statsTurn == gs.turnCount - 1) ? stats.Decayed(K_PLAN_REUSE_DECAY) : PlanStats{};
+
+    //independent streams per turn and thread
+    auto Stream = [&](int thread) { return seed * 0x100000001B3ull + (uint64_t)gs.turnCount * 0x10001ull + (uint64_t)thread * 0x9E3779B97F4A7C15ull; };
+
+    if(threadCount > 1)
     {
-        Ship& enemy = gs.FindBestEnemy();
-        point = lerp(enemy.pos, gs.checkpoints[enemy.nextCheckpointIdx], 0.5f);
-        radius = 100.0f;
+        //workers never share a bump pointer, the vector only grows when threadCount changes
+        arenas.resize(threadCount);
+        for(Arena& arena : arenas) arena.Reserve(K_ARENA_BYTES);
+        PlanStats* results = gs.arena.New<PlanStats>(threadCount);
+        auto task = [&](int thread) { results[thread] = Search(gs, base, prior, Stream(thread), iterations, deadline, arenas[thread]); };
+        PlannerPool(threadCount).Run(task);
+        stats = results[0];
+        for(int t=1; t < threadCount; ++t) stats.Merge(results[t]);
     }
-    else if(ship.command == Command::SeekCheckpoint)
+    else
     {
-        //if going with high speed towards the point, already prep next point
-        if(velocityLength >= 400.0f && (ship.pos - point).Length() <= 2000.0f)
-        {
-            point = gs.checkpoints[(ship.nextCheckpointIdx+1)%gs.checkpointCount];
-        }
+        stats = Search(gs, base, prior, Stream(0), iterations, deadline, gs.arena);
     }
+    stats.Merge(prior);
+    statsTurn = gs.turnCount;
 
-    Vec2 diff = (ship.pos - point);
-    ship.dest = point + diff.Normalized() * radius;
-
-    float approach = clamp01(diff.Length() / (K_CHECKPOINT_RADIUS * 2.0f));
-    //set up the output target coord accounting for inertia
-    ship.targetCoord = ship.dest - ship.velocity * 2.75f * approach;
+    int arm = stats.Best();
+    for(int i=0; i < K_PLAYERCOUNT; ++i)
+    {
+        Ship& ship = gs.Player(i);
+        PodAction action = PlanMove(ship.State(), base[i], (i == 0) ? arm / K_PLAN_MOVES : arm % K_PLAN_MOVES);
+        ship.targetCoord = action.target;
+        ship.thrust = action.thrust;
+        if(action.shield != base[i].shield) ship.shieldReason = ShieldPlanned;
+        if(action.boost != base[i].boost) ship.boostReason = BoostPlanned;
+        ship.doShield = action.shield;
+        ship.doBoost = action.boost;
+        gs.usedBoost = gs.usedBoost && !(base[i].boost && !action.boost); //a dropped boost stays available
+    }
 }
 
-//outputs the desired travel direction and thrust value
-void EvaluateThrust(GameState& gs, Ship& ship)
+//whether a player pod can keep following its plan this turn
+ReplanReason CheckPlan(const GameState& gs, const Ship& ship)
 {
-    Vec2 direction = ship.dest - ship.pos;
-    float dist = direction.Length();
-    float thrust = K_MAX_THRUST;
+    const PodPlan& plan = ship.plan;
+    if(plan.step >= plan.length) return ReplanNoPlan;
+    if(ship.command == Command::SeekCheckpoint && !gs.usedBoost && ship.nextCheckpointIdx == gs.optimalBoostIdx) return ReplanBoost;
 
-    thrust *= clamp01(dist / (K_CHECKPOINT_RADIUS * 2.0f)); //slow down next to checkpoints to avoid overshooting
+    const PodState& expected = plan.states[plan.step];
+    bool onCourse = ship.nextCheckpointIdx == expected.nextCheckpointIdx
+        && (ship.pos - expected.pos).Length() <= K_REPLAN_POS_TOLERANCE
+        && (ship.velocity - expected.velocity).Length() <= K_REPLAN_SPEED_TOLERANCE
+        && abs(AngleDiff(ship.angle, expected.angle)) <= K_REPLAN_ANGLE_TOLERANCE;
+    if(!onCourse) return ReplanDeviation;
 
-    //fine steering when not facing away from point
-    float dot = direction.Normalized().Dot(ship.velocity.Normalized());
-    if(dot > 0.0f)
+    //the bumper's plan aims where it expected the leading enemy, which has to be on course too
+    if(ship.command == Command::BumpStrongestEnemy)
     {
-        thrust *= clamp01(dot);
+        Vec2 dest;
+        PodAction now = BumpAction(gs, ship.State(), gs.FindBestEnemy().State(), dest);
+        if((now.target - plan.actions[plan.step].target).Length() > K_REPLAN_AIM_TOLERANCE) return ReplanDeviation;
     }
-    
-    ship.thrust = thrust;
+
+    if(IsThreatened(gs, ship)) return ReplanThreat;
+    float contact = 0.0f;
+    for(int k=plan.step + 1; k < plan.length; ++k) contact += gs.occupancy.At(min(k - plan.step - 1, K_OCCUPANCY_TURNS - 1), plan.states[k].pos);
+    return (contact > K_REPLAN_CONTACT) ? ReplanThreat : ReplanNone;
 }
 
-// When catching a long road to the next checkpoint, why not also boost?
-void EvaluateShouldBoost(GameState& gs, Ship& ship)
+// Sends the next step of both player pods' plans when both are still on them; the planner
+// chooses for the two pods together, so one of them leaving its plan replans both.
+bool FollowPlans(GameState& gs)
 {
-    if(ship.command != Command::SeekCheckpoint)
+    bool onPlan = true;
+    for(int i=0; i < K_PLAYERCOUNT; ++i)
     {
-        ship.doBoost = false;
-        return;
+        Ship& ship = gs.Player(i);
+        ship.replanReason = CheckPlan(gs, ship);
+        gs.replans.reasons[i][ship.replanReason]++;
+        onPlan = onPlan && ship.replanReason == ReplanNone;
     }
+    if(!onPlan) return false;
 
-    ship.doBoost = true;
-    gs.usedBoost = true;
+    for(int i=0; i < K_PLAYERCOUNT; ++i)
+    {
+        Ship& ship = gs.Player(i);
+        const PodAction& action = ship.plan.actions[ship.plan.step++];
+        ship.targetCoord = action.target;
+        ship.thrust = action.thrust;
+        ship.doShield = false;
+        ship.shieldReason = ShieldNotThreatened;
+        ship.shieldGain = 0.0f;
+        EvaluateShouldBoost(gs, ship); //never fires on a plan, only explains why
+    }
+    return true;
 }
 
-// When enemy gets near, shield self
-void EvaluateShouldShield(GameState& gs, Ship& ship)
+// The chosen actions, then what the heuristics would do from the expected states, as both
+// player pods' new plans. Enemies follow the rollout policy.
+void MakePlans(GameState& gs)
 {
-    constexpr float impactDistTolerance = K_POD_RADIUS * 2.0f;
-    bool doShield = false;
-    Vec2 shipVelNorm = ship.velocity.Normalized();
+    PodState pods[K_TOTAL_SHIPCOUNT];
+    PodAction actions[K_TOTAL_SHIPCOUNT];
+    for(int i=0; i < K_TOTAL_SHIPCOUNT; ++i) pods[i] = gs.ships[i].State();
 
-    for(int i=0; i < K_TOTAL_SHIPCOUNT; ++i)
+    for(int turn=0; turn < K_POD_PLAN_TURNS; ++turn)
     {
-        Ship& other = gs.ships[i];
-        if(other.id == ship.id) continue;
+        RolloutActions(gs, pods, actions);
+        int leader = (RaceProgress(gs, pods[K_PLAYERCOUNT]) >= RaceProgress(gs, pods[K_PLAYERCOUNT+1])) ? K_PLAYERCOUNT : K_PLAYERCOUNT+1;
+        for(int i=0; i < K_PLAYERCOUNT; ++i)
+        {
+            PodPlan& plan = gs.Player(i).plan;
+            Vec2 dest;
+            if(turn == 0) actions[i] = gs.Player(i).Action();
+            else if(gs.Player(i).command == Command::BumpStrongestEnemy) actions[i] = BumpAction(gs, pods[i], pods[leader], dest);
+            plan.states[turn] = pods[i];
+            plan.actions[turn] = actions[i];
+        }
+        SimulateTurn(pods, actions, K_TOTAL_SHIPCOUNT, gs.checkpoints, gs.checkpointCount);
+    }
 
-        //do not interfere with your checkpoint seeking ally, let him bonk you
-        if(other.isPlayer && other.command == Command::SeekCheckpoint) continue;
+    for(int i=0; i < K_PLAYERCOUNT; ++i)
+    {
+        gs.Player(i).plan.length = K_POD_PLAN_TURNS;
+        gs.Player(i).plan.step = 1;
+    }
+}
+#endif
 
-        bool otherIsClose = (ship.pos - other.pos).Length() <= impactDistTolerance;
-        bool willImpact = ((ship.pos + ship.velocity) - (other.pos + other.velocity)).Length() <= impactDistTolerance;
+#ifndef GOLD_TELEMETRY
+#define GOLD_TELEMETRY 0
+#endif
+
+enum TelemetryFormat
+{
+    TelemetryOff,
+    TelemetryNdjson,
+    TelemetryBinary
+};
+
+//-DGOLD_TELEMETRY=1 writes NDJSON, =2 binary records, to stderr or -DGOLD_TELEMETRY_FILE=\"path\"
+constexpr TelemetryFormat K_TELEMETRY = (TelemetryFormat)GOLD_TELEMETRY;
+constexpr int K_TELEMETRY_RING = 16; //turns staged before the oldest is dropped
+constexpr int K_TELEMETRY_PREDICT_TURNS = 5;
+constexpr uint32_t K_TELEMETRY_MAGIC = 0x54425343; //"CSBT" in a little endian file
+
+enum TelemetryStage
+{
+    StageForecast,
+    StageHeuristics,
+    StageShield,
+    StagePlanner,
+    StageOutput,
+    StageCount
+};
+
+const char* K_STAGE_NAMES[StageCount] = {"forecast", "heuristics", "shield", "planner", "output"};
+
+struct TelemetryPod
+{
+    float pos[2];
+    float velocity[2];
+    float angle;
+    int32_t nextCheckpointIdx;
+    int32_t checkpointsPassedCount;
+    float target[2];
+    float thrust;
+    float shieldGain;
+    uint8_t role; //Command for player pods, K_ROLE_ENEMY otherwise
+    uint8_t shield;
+    uint8_t boost;
+    uint8_t shieldReason;
+    uint8_t boostReason;
+    uint8_t replanReason;
+    uint8_t padding[2];
+    float predicted[K_TELEMETRY_PREDICT_TURNS][2]; //positions after each of the next turns
+};
+
+constexpr uint8_t K_ROLE_ENEMY = 2;
+const char* K_ROLE_NAMES[3] = {"runner", "bumper", "enemy"};
+
+//one turn as a fixed size record, also the binary stream format
+struct TelemetryTurn
+{
+    uint32_t magic;
+    uint32_t turn;
+    uint32_t dropped; //records lost to a full ring before this one
+    uint32_t replanTurns; //ReplanCounters so far
+    uint32_t lazyTurns;
+    float savedUs;
+    float stageUs[StageCount];
+    TelemetryPod pods[K_TOTAL_SHIPCOUNT];
+};
+
+// Stages a raw record per turn in a ring and only formats and writes them in Flush, which the
+// game loop calls after WriteOutput, so telemetry never delays the response.
+struct Telemetry
+{
+    FILE* out = nullptr;
+    TelemetryTurn ring[K_TELEMETRY_RING];
+    int head = 0;
+    int count = 0;
+    uint32_t dropped = 0;
+    float stageUs[StageCount];
+    chrono::steady_clock::time_point stageStart;
+
+    void BeginTurn()
+    {
+        std::fill(stageUs, stageUs + StageCount, 0.0f);
+        stageStart = chrono::steady_clock::now();
+    }
+
+    //charges the time since the previous mark to stage
+    void Stage(TelemetryStage stage)
+    {
+        auto now = chrono::steady_clock::now();
+        stageUs[stage] += chrono::duration<float, micro>(now - stageStart).count();
+        stageStart = now;
+    }
 
-        if(!(otherIsClose || willImpact)) continue;
+    void Record(const GameState& gs);
 
-        bool otherIsInFront = ship.pos.Dot(shipVelNorm) < other.pos.Dot(shipVelNorm);
-        bool impactAngleIsBad = ship.velocity.Normalized().Dot(other.velocity.Normalized()) <= 0.25f;
-        
-        if(ship.command == Command::BumpStrongestEnemy)
+    void Flush()
+    {
+        if(!out)
         {
-            doShield = true;
-            break;
+#ifdef GOLD_TELEMETRY_FILE
+            out = fopen(GOLD_TELEMETRY_FILE, (K_TELEMETRY == TelemetryBinary) ? "wb" : "w");
+#endif
+            if(!out) out = stderr;
         }
-        else if((ship.command == Command::SeekCheckpoint) && (impactAngleIsBad || otherIsInFront))
+
+        for(; count > 0; --count)
         {
-            doShield = true;
-            break;
+            const TelemetryTurn& record = ring[(head - count + K_TELEMETRY_RING) % K_TELEMETRY_RING];
+            if(K_TELEMETRY == TelemetryBinary) fwrite(&record, sizeof(record), 1, out);
+            else WriteNdjson(record);
+        }
+        fflush(out);
+    }
+
+    void WriteNdjson(const TelemetryTurn& t)
+    {
+        fprintf(out, "{\"turn\":%u,\"dropped\":%u,\"replans\":{\"replan_turns\":%u,\"lazy_turns\":%u,\"saved_us\":%.1f},\"stages_us\":{",
+            t.turn, t.dropped, t.replanTurns, t.lazyTurns, t.savedUs);
+        for(int s=0; s < StageCount; ++s) fprintf(out, "%s\"%s\":%.1f", s ? "," : "", K_STAGE_NAMES[s], t.stageUs[s]);
+        fprintf(out, "},\"pods\":[");
+        for(int i=0; i < K_TOTAL_SHIPCOUNT; ++i)
+        {
+            const TelemetryPod& p = t.pods[i];
+            fprintf(out, "%s{\"role\":\"%s\",\"pos\":[%.0f,%.0f],\"vel\":[%.0f,%.0f],\"angle\":%.1f,\"cp\":%d,\"passed\":%d,"
+                "\"target\":[%.0f,%.0f],\"thrust\":%.0f,\"shield\":%d,\"shield_reason\":\"%s\",\"shield_gain\":%.1f,\"boost\":%d,\"boost_reason\":\"%s\",\"replan_reason\":\"%s\",\"predicted\":[",
+                i ? "," : "", K_ROLE_NAMES[p.role], p.pos[0], p.pos[1], p.velocity[0], p.velocity[1], p.angle, p.nextCheckpointIdx, p.checkpointsPassedCount,
+                p.target[0], p.target[1], p.thrust, p.shield, K_SHIELD_REASON_NAMES[p.shieldReason], p.shieldGain, p.boost, K_BOOST_REASON_NAMES[p.boostReason], K_REPLAN_REASON_NAMES[p.replanReason]);
+            for(int k=0; k < K_TELEMETRY_PREDICT_TURNS; ++k) fprintf(out, "%s[%.0f,%.0f]", k ? "," : "", p.predicted[k][0], p.predicted[k][1]);
+            fprintf(out, "]}");
+        }
+        fprintf(out, "]}\n");
+    }
+};
+
+Telemetry telemetry;
+
+//stages the decided turn, with every pod's predicted path under the chosen and rollout actions
+void Telemetry::Record(const GameState& gs)
+{
+    if(count == K_TELEMETRY_RING)
+    {
+        count--;
+        dropped++;
+    }
+    TelemetryTurn& t = ring[head];
+    head = (head + 1) % K_TELEMETRY_RING;
+    count++;
+
+    t.magic = K_TELEMETRY_MAGIC;
+    t.turn = gs.turnCount;
+    t.dropped = dropped;
+    t.replanTurns = gs.replans.replanTurns;
+    t.lazyTurns = gs.replans.lazyTurns;
+    t.savedUs = (float)gs.replans.SavedUs();
+    std::copy(stageUs, stageUs + StageCount, t.stageUs);
+
+    PodState pods[K_TOTAL_SHIPCOUNT];
+    PodAction actions[K_TOTAL_SHIPCOUNT];
+    for(int i=0; i < K_TOTAL_SHIPCOUNT; ++i)
+    {
+        const Ship& ship = gs.ships[i];
+        TelemetryPod& p = t.pods[i];
+        pods[i] = ship.State();
+        p = {};
+        p.pos[0] = ship.pos.x;
+        p.pos[1] = ship.pos.y;
+        p.velocity[0] = ship.velocity.x;
+        p.velocity[1] = ship.velocity.y;
+        p.angle = ship.angle;
+        p.nextCheckpointIdx = ship.nextCheckpointIdx;
+        p.checkpointsPassedCount = ship.checkpointsPassedCount;
+        p.role = K_ROLE_ENEMY;
+        if(i < K_PLAYERCOUNT)
+        {
+            PodAction action = ship.Action();
+            p.role = (uint8_t)ship.command;
+            p.target[0] = action.target.x;
+            p.target[1] = action.target.y;
+            p.thrust = action.thrust;
+            p.shield = action.shield;
+            p.boost = action.boost;
+            p.shieldReason = ship.shieldReason;
+            p.shieldGain = ship.shieldGain;
+            p.boostReason = ship.boostReason;
+            p.replanReason = ship.replanReason;
         }
     }
-    
-    ship.doShield = doShield;
+
+    for(int turn=0; turn < K_TELEMETRY_PREDICT_TURNS; ++turn)
+    {
+        RolloutActions(gs, pods, actions);
+        for(int i=0; i < K_PLAYERCOUNT && turn == 0; ++i) actions[i] = gs.ships[i].Action();
+        SimulateTurn(pods, actions, K_TOTAL_SHIPCOUNT, gs.checkpoints, gs.checkpointCount);
+        for(int i=0; i < K_TOTAL_SHIPCOUNT; ++i)
+        {
+            t.pods[i].predicted[turn][0] = pods[i].pos.x;
+            t.pods[i].predicted[turn][1] = pods[i].pos.y;
+        }
+    }
+}
+
+//heuristics, shield evaluation and planner from scratch
+void DecideFresh(GameState& gs)
+{
+    for(int i=0; i < K_PLAYERCOUNT; ++i)
+    {
+        EvaluateTargetCoord(gs, gs.Player(i));
+        EvaluateThrust(gs, gs.Player(i));
+        EvaluateShouldBoost(gs, gs.Player(i));
+    }
+    if(K_TELEMETRY) telemetry.Stage(StageHeuristics);
+
+    EvaluateShouldShield(gs);
+    if(K_TELEMETRY) telemetry.Stage(StageShield);
+
+#ifdef GOLD_LOCAL
+    if(K_USE_PLANNER)
+    {
+        int iterations = gs.planner.Allocate(TurnCriticality(gs));
+        float budgetMs = min(K_PLAN_MAX_BUDGET_MS, K_PLAN_BUDGET_MS * iterations / K_PLAN_ITERATIONS);
+        gs.planner.Plan(gs, iterations, chrono::steady_clock::now() + chrono::microseconds((int)(budgetMs * 1000.0f)));
+        if(K_TELEMETRY) telemetry.Stage(StagePlanner);
+    }
+#endif
+}
+
+#ifdef GOLD_LOCAL
+// Follows both player pods' plans while they hold, otherwise decides from scratch and plans
+// again, counting which it was and what it cost.
+void DecideLazy(GameState& gs)
+{
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    if(FollowPlans(gs))
+    {
+        if(K_TELEMETRY) telemetry.Stage(StagePlanner);
+        gs.planner.Follow(gs.turnCount);
+        gs.replans.lazyTurns++;
+        gs.replans.lazyUs += chrono::duration<double, micro>(chrono::steady_clock::now() - start).count();
+        return;
+    }
+
+    DecideFresh(gs);
+    MakePlans(gs);
+    gs.replans.replanTurns++;
+    gs.replans.replanUs += chrono::duration<double, micro>(chrono::steady_clock::now() - start).count();
+}
+#endif
+
+//picks the commands of both player pods for this turn
+void DecideTurn(GameState& gs)
+{
+    gs.arena.Reset();
+
+    for(int i=0; i < K_PLAYERCOUNT; ++i)
+    {
+        gs.Player(i).command = (i == 0) ? Command::SeekCheckpoint : Command::BumpStrongestEnemy;
+    }
+
+    //every turn, the forecast blends in the previous one, the runner and the plans steer by it
+    PodState enemies[K_ENEMYCOUNT];
+    for(int i=0; i < K_ENEMYCOUNT; ++i) enemies[i] = gs.Enemy(i).State();
+    gs.occupancy.Update(enemies, K_ENEMYCOUNT, gs.checkpoints, gs.arena);
+#ifdef GOLD_LOCAL
+    if(K_USE_PLANNER) gs.opponents.Observe(gs);
+#endif
+    if(K_TELEMETRY) telemetry.Stage(StageForecast);
+
+#ifdef GOLD_LOCAL
+    if(K_USE_PLANNER && K_LAZY_REPLAN) DecideLazy(gs);
+    else
+#endif
+    DecideFresh(gs);
+
+    for(int i=0; i < K_PLAYERCOUNT; ++i)
+    {
+        Ship& ship = gs.Player(i);
+        if(ship.doShield) ship.shieldCooldown = K_SHIELD_COOLDOWN;
+        else if(ship.shieldCooldown > 0) ship.shieldCooldown--;
+    }
 }
 
 void WriteOutput(const Ship& ship)
@@ -294,6 +2395,7 @@ void WriteOutput(const Ship& ship)
     cout << endl;
 }
 
+#ifndef GOLD_NO_MAIN
 int main()
 {
     GameState gs;
@@ -303,25 +2405,21 @@ int main()
     while (1) 
     {
         gs.ReadInput();
+        if(K_TELEMETRY) telemetry.BeginTurn();
+        DecideTurn(gs);
 
         for(int i=0; i < K_PLAYERCOUNT; ++i)
         {
-            gs.Player(i).command = (i == 0) ? Command::SeekCheckpoint : Command::BumpStrongestEnemy;
-
-            EvaluateTargetCoord(gs, gs.Player(i));
-            EvaluateThrust(gs, gs.Player(i));
-            EvaluateShouldBoost(gs, gs.Player(i));
-            EvaluateShouldShield(gs, gs.Player(i));
+            WriteOutput(gs.Player(i));
         }
 
-        for(int i=0; i < K_PLAYERCOUNT; ++i)
+        if(K_TELEMETRY)
         {
-            WriteOutput(gs.Player(i));
+            telemetry.Stage(StageOutput);
+            telemetry.Record(gs);
+            telemetry.Flush();
         }
-
-        //cerr<< " p:" << p << " e:" << e << " " << endl;
-
-        //cout << endl;
         gs.turnCount++;
     }
-}
\ No newline at end of file
+}
+#endif
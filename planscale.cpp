@@ -0,0 +1,90 @@
+// Thread scaling report of the root parallel TurnPlanner, not a submission.
+// build: g++ -std=c++17 -O2 -pthread -DGOLD_LOCAL -o planscale planscale.cpp
+//
+// planscale [maxThreads] [iterations] [seed]
+//
+// Collects game states from seeded gold vs silver races, then plans each of them with
+// 1, 2, 4 ... maxThreads threads. The iteration budget is split between the threads, so
+// the rows compare the wall time of the same amount of search. Every thread count plans
+// twice to check the merged statistics are identical, and reports how often it picks the
+// same joint action as the single threaded search.
+
+#include "race.h"
+
+#include <cstring>
+#include <thread>
+
+#ifndef GOLD_LOCAL
+#error planscale needs the GOLD_LOCAL build, compile with -DGOLD_LOCAL -pthread
+#endif
+
+constexpr int K_SCALE_RACES = 8;
+constexpr int K_SCALE_STATE_INTERVAL = 15; //turns between collected states
+
+double Seconds(chrono::steady_clock::time_point from)
+{
+    return chrono::duration<double>(chrono::steady_clock::now() - from).count();
+}
+
+vector<GameState> CollectStates(uint32_t seed)
+{
+    vector<GameState> states;
+    mt19937 rng(seed);
+    for(int r=0; r < K_SCALE_RACES; ++r)
+    {
+        Track track = RandomTrack(rng);
+        Bot gold{PolicyGold}, silver{PolicySilver};
+        PlayRace(track, gold, silver, [&](const Race& race, const PodAction*)
+        {
+            if(race.turn % K_SCALE_STATE_INTERVAL == 0) states.push_back(gold.gs);
+        });
+    }
+    return states;
+}
+
+int main(int argc, char** argv)
+{
+    int maxThreads = (argc > 1) ? atoi(argv[1]) : (int)thread::hardware_concurrency();
+    int iterations = (argc > 2) ? atoi(argv[2]) : 32768;
+    uint32_t seed = (argc > 3) ? (uint32_t)atoi(argv[3]) : 1;
+    auto noDeadline = chrono::steady_clock::time_point::max();
+
+    vector<GameState> states = CollectStates(seed);
+    printf("%zu states, %d iterations per state, seed %u\n", states.size(), iterations, seed);
+    printf("%8s %10s %12s %8s %10s %8s %13s\n", "threads", "ms/state", "iter/s", "speedup", "efficiency", "agree", "deterministic");
+
+    vector<int> singleArms;
+    double singleTime = 0.0;
+    for(int threads=1; threads <= max(1, maxThreads); threads *= 2)
+    {
+        int agree = 0;
+        bool deterministic = true;
+        double time = 0.0;
+        for(size_t s=0; s < states.size(); ++s)
+        {
+            GameState gs = states[s];
+            gs.planner.seed = seed;
+            gs.planner.threadCount = threads;
+
+            auto start = chrono::steady_clock::now();
+            gs.planner.Plan(gs, iterations / threads, noDeadline);
+            time += Seconds(start);
+            PlanStats first = gs.planner.stats;
+
+            gs = states[s];
+            gs.planner.seed = seed;
+            gs.planner.threadCount = threads;
+            gs.planner.Plan(gs, iterations / threads, noDeadline);
+            deterministic = deterministic && gs.planner.stats == first;
+
+            if(threads == 1) singleArms.push_back(first.Best());
+            agree += (first.Best() == singleArms[s]);
+        }
+
+        if(threads == 1) singleTime = time;
+        double speedup = singleTime / time;
+        printf("%8d %10.2f %12.0f %8.2f %9.0f%% %7.0f%% %13s\n", threads, time * 1e3 / states.size(), (double)iterations * states.size() / time,
+            speedup, 100.0 * speedup / threads, 100.0 * agree / states.size(), deterministic ? "yes" : "NO");
+    }
+    return 0;
+}
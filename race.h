@@ -0,0 +1,175 @@
+// Local race harness shared by the offline tools, not a submission.
+// Runs whole 2v2 races in-process with the referee physics from gold.cpp and
+// drives the decision logic of every league bot without going through text.
+#pragma once
+
+#define GOLD_NO_MAIN
+#include "gold.cpp"
+
+#include <random>
+
+constexpr int K_MIN_CHECKPOINTS = 2;
+constexpr float K_CHECKPOINT_SPACING = 2500.0f; //minimum distance between any two checkpoints
+constexpr int K_CHECKPOINT_MARGIN = 1000; //minimum distance of a checkpoint center to the map edge
+constexpr int K_RACE_LAPS = 3;
+constexpr int K_TIMEOUT_TURNS = 100; //a player loses when none of its pods crossed a checkpoint for this long
+constexpr int K_MAX_RACE_TURNS = 1000;
+
+struct Track
+{
+    int lapCount;
+    int checkpointCount;
+    Vec2 checkpoints[K_MAX_CHECKPOINTS];
+};
+
+//a track as the referee lays them out: checkpoints inside the margin and well apart from each other
+Track RandomTrack(mt19937& rng, int checkpointCount)
+{
+    Track track;
+    track.lapCount = K_RACE_LAPS;
+    track.checkpointCount = checkpointCount;
+    uniform_int_distribution<int> px(K_CHECKPOINT_MARGIN, K_MAP_WIDTH - K_CHECKPOINT_MARGIN), py(K_CHECKPOINT_MARGIN, K_MAP_HEIGHT - K_CHECKPOINT_MARGIN);
+    for(int i=0; i < track.checkpointCount; ++i)
+    {
+        bool spaced = false;
+        while(!spaced)
+        {
+            track.checkpoints[i] = {(float)px(rng), (float)py(rng)};
+            spaced = true;
+            for(int j=0; j < i; ++j)
+            {
+                spaced = spaced && (track.checkpoints[j] - track.checkpoints[i]).Length() >= K_CHECKPOINT_SPACING;
+            }
+        }
+    }
+    return track;
+}
+
+Track RandomTrack(mt19937& rng)
+{
+    return RandomTrack(rng, uniform_int_distribution<int>(K_MIN_CHECKPOINTS, K_MAX_CHECKPOINTS)(rng));
+}
+
+// A race in progress. Player 0 owns pods 0 and 1, player 1 owns pods 2 and 3.
+struct Race
+{
+    Track track;
+    PodState pods[K_TOTAL_SHIPCOUNT];
+    int turn = 0;
+    int timeout[K_PLAYERCOUNT];
+    int winner = -1; //player index, K_PLAYERCOUNT for a draw at the turn limit
+
+    void Start(const Track& raceTrack)
+    {
+        track = raceTrack;
+        turn = 0;
+        winner = -1;
+        std::fill(timeout, timeout + K_PLAYERCOUNT, K_TIMEOUT_TURNS);
+
+        //pods line up across the first leg, each player gets one inner and one outer slot
+        constexpr float offsets[K_TOTAL_SHIPCOUNT] = {-1500.0f, 500.0f, -500.0f, 1500.0f};
+        Vec2 leg = (track.checkpoints[1] - track.checkpoints[0]).Normalized();
+        Vec2 side = {-leg.y, leg.x};
+        for(int i=0; i < K_TOTAL_SHIPCOUNT; ++i)
+        {
+            Vec2 pos = track.checkpoints[0] + side * offsets[i];
+            pods[i] = {{roundf(pos.x), roundf(pos.y)}, {0.0f, 0.0f}, -1.0f, 1, 0};
+        }
+    }
+
+    bool Finished() const { return winner >= 0; }
+    static int Owner(int pod) { return pod / K_PLAYERCOUNT; }
+
+    //the pods as a player's input lists them: its own first
+    void View(int player, PodState* out) const
+    {
+        for(int i=0; i < K_TOTAL_SHIPCOUNT; ++i)
+        {
+            out[i] = pods[(i + player * K_PLAYERCOUNT) % K_TOTAL_SHIPCOUNT];
+        }
+    }
+
+    void Step(const PodAction* actions)
+    {
+        int passed[K_TOTAL_SHIPCOUNT];
+        for(int i=0; i < K_TOTAL_SHIPCOUNT; ++i) passed[i] = pods[i].checkpointsPassedCount;
+
+        SimulateTurn(pods, actions, K_TOTAL_SHIPCOUNT, track.checkpoints, track.checkpointCount);
+        turn++;
+
+        for(int p=0; p < K_PLAYERCOUNT; ++p) timeout[p]--;
+        for(int i=0; i < K_TOTAL_SHIPCOUNT; ++i)
+        {
+            if(pods[i].checkpointsPassedCount == passed[i]) continue;
+            timeout[Owner(i)] = K_TIMEOUT_TURNS;
+            if(winner < 0 && pods[i].checkpointsPassedCount >= track.lapCount * track.checkpointCount)
+            {
+                winner = Owner(i);
+            }
+        }
+
+        for(int p=0; p < K_PLAYERCOUNT && winner < 0; ++p)
+        {
+            if(timeout[p] <= 0) winner = K_PLAYERCOUNT - 1 - p;
+        }
+        if(winner < 0 && turn >= K_MAX_RACE_TURNS) winner = K_PLAYERCOUNT;
+    }
+};
+
+// One player's bot of any league, named by its policy. The single pod leagues drive both
+// pods the same way through the policy zoo, gold runs its full decision turn on its own GameState.
+struct Bot
+{
+    PolicyKind kind;
+    GameState gs; //only the track for the league policies
+
+    void Start(const Track& track)
+    {
+        gs = {};
+        gs.lapCount = track.lapCount;
+        gs.checkpointCount = track.checkpointCount;
+        std::copy(track.checkpoints, track.checkpoints + track.checkpointCount, gs.checkpoints);
+        if(kind == PolicyGold) gs.InitializeTrack();
+    }
+
+    void Decide(const Race& race, int player, PodAction* actions)
+    {
+        PodState view[K_TOTAL_SHIPCOUNT];
+        race.View(player, view);
+
+        if(kind == PolicyGold)
+        {
+            for(int i=0; i < K_TOTAL_SHIPCOUNT; ++i)
+            {
+                gs.UpdateShip(i, view[i].pos, view[i].velocity, view[i].angle, view[i].nextCheckpointIdx);
+            }
+            DecideTurn(gs);
+            for(int i=0; i < K_PLAYERCOUNT; ++i) actions[i] = gs.Player(i).Action();
+            gs.turnCount++;
+            return;
+        }
+
+        PolicyActions(kind, gs, view, 0, actions);
+    }
+};
+
+// Plays one whole race between two bots. onTurn(race, actions) sees every turn's
+// state before the actions are applied.
+template<typename OnTurn>
+int PlayRace(const Track& track, Bot& first, Bot& second, OnTurn onTurn)
+{
+    Race race;
+    race.Start(track);
+    first.Start(track);
+    second.Start(track);
+
+    while(!race.Finished())
+    {
+        PodAction actions[K_TOTAL_SHIPCOUNT];
+        first.Decide(race, 0, actions);
+        second.Decide(race, 1, actions + K_PLAYERCOUNT);
+        onTurn(race, actions);
+        race.Step(actions);
+    }
+    return race.winner;
+}
@@ -0,0 +1,465 @@
+// Multiplexed local match runner for bot executables, not a submission.
+// build: g++ -std=c++17 -O2 -pthread -o runner runner.cpp
+//
+// runner [--matches N] [--parallel P] [--workers W] [--timeout ms] [--first-timeout ms] [--seed S] <botA> <botB>
+//
+// Both bots are executables speaking the gold league protocol on stdin and stdout. Every
+// race spawns a fresh process of each, sides alternate between races. A few worker threads
+// share the races in flight and each waits on all of its bots' pipes with one epoll set,
+// so hundreds of bot processes cost file descriptors, not threads. A bot that misses the
+// turn limit, dies or sends a line the referee would reject loses the race, as on the
+// server. Response times run from writing a bot's input to reading its last command line.
+// Races in flight beyond a few per core only make bots that think for their whole turn late.
+
+#include "race.h"
+
+#include <atomic>
+#include <cstring>
+#include <fcntl.h>
+#include <signal.h>
+#include <spawn.h>
+#include <sys/epoll.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+
+extern char** environ;
+
+constexpr int K_RUNNER_MATCHES = 100;
+constexpr int K_RUNNER_RACES_PER_CORE = 4; //default races in flight, bots that think for their whole turn need the cores
+constexpr float K_RUNNER_TIMEOUT_MS = 75.0f;
+constexpr float K_RUNNER_FIRST_TIMEOUT_MS = 1000.0f;
+constexpr int K_RUNNER_EVENTS = 64; //epoll events handled per wait
+constexpr size_t K_RUNNER_MAX_LINE = 256; //longer output is rejected rather than buffered
+
+using Clock = chrono::steady_clock;
+
+double Ms(Clock::duration d) { return chrono::duration<double, milli>(d).count(); }
+
+//one output line as the referee reads it: "x y thrust", "x y BOOST" or "x y SHIELD"
+bool ParseAction(const string& line, PodAction& action)
+{
+    int x, y;
+    char word[16];
+    if(sscanf(line.c_str(), "%d %d %15s", &x, &y, word) != 3) return false;
+
+    action = {{(float)x, (float)y}, K_MAX_THRUST};
+    if(strcmp(word, "BOOST") == 0) action.boost = true;
+    else if(strcmp(word, "SHIELD") == 0) action.shield = true;
+    else
+    {
+        char* end;
+        long thrust = strtol(word, &end, 10);
+        if(*end != '\0' || thrust < 0 || thrust > (long)K_MAX_THRUST) return false;
+        action.thrust = (float)thrust;
+    }
+    return true;
+}
+
+enum Outcome
+{
+    OutcomeOk,
+    OutcomeTimeout,
+    OutcomeInvalid //bad line, crash or closed pipe
+};
+
+struct Match;
+
+// One bot process of a race, the pipe ends stay non-blocking so a worker never waits on a
+// single bot.
+struct BotProcess
+{
+    Match* match = nullptr;
+    int player = 0;
+    pid_t pid = -1;
+    int in = -1; //the bot's stdin
+    int out = -1; //the bot's stdout
+    string buffer;
+    int lines = 0; //command lines read this turn
+    bool waiting = false;
+    Outcome outcome = OutcomeOk;
+    Clock::time_point sent;
+    Clock::time_point answered; //when the turn's last command line came in
+    Clock::time_point deadline;
+    PodAction actions[K_PLAYERCOUNT];
+
+    bool Spawn(const char* path, int epoll)
+    {
+        int toBot[2], fromBot[2];
+        if(pipe2(toBot, O_CLOEXEC) != 0) return false;
+        if(pipe2(fromBot, O_CLOEXEC) != 0)
+        {
+            close(toBot[0]);
+            close(toBot[1]);
+            return false;
+        }
+
+        //posix_spawn instead of fork, other workers may be spawning at the same time
+        posix_spawn_file_actions_t files;
+        posix_spawn_file_actions_init(&files);
+        posix_spawn_file_actions_adddup2(&files, toBot[0], STDIN_FILENO);
+        posix_spawn_file_actions_adddup2(&files, fromBot[1], STDOUT_FILENO);
+        posix_spawn_file_actions_addopen(&files, STDERR_FILENO, "/dev/null", O_WRONLY, 0);
+        char* args[] = {(char*)path, nullptr};
+        int error = posix_spawn(&pid, path, &files, nullptr, args, environ);
+        posix_spawn_file_actions_destroy(&files);
+
+        close(toBot[0]);
+        close(fromBot[1]);
+        in = toBot[1];
+        out = fromBot[0];
+        if(error != 0)
+        {
+            pid = -1;
+            return false;
+        }
+
+        fcntl(in, F_SETFL, fcntl(in, F_GETFL) | O_NONBLOCK);
+        fcntl(out, F_SETFL, fcntl(out, F_GETFL) | O_NONBLOCK);
+        epoll_event event = {};
+        event.events = EPOLLIN;
+        event.data.ptr = this;
+        return epoll_ctl(epoll, EPOLL_CTL_ADD, out, &event) == 0;
+    }
+
+    void Stop(int epoll)
+    {
+        if(out >= 0)
+        {
+            epoll_ctl(epoll, EPOLL_CTL_DEL, out, nullptr);
+            close(out);
+        }
+        if(in >= 0) close(in);
+        if(pid > 0)
+        {
+            kill(pid, SIGKILL);
+            waitpid(pid, nullptr, 0);
+        }
+        in = out = pid = -1;
+    }
+
+    //a whole turn's input in one write; it is far below PIPE_BUF, so a bot that let its
+    //pipe fill up is as late as one that does not answer
+    void Send(const string& text, float timeoutMs)
+    {
+        buffer.erase(0, buffer.find_last_of('\n') + 1); //lines past the last turn's commands are stale
+        lines = 0;
+        waiting = true;
+        sent = Clock::now();
+        deadline = sent + chrono::microseconds((long)(timeoutMs * 1000.0f));
+        if(write(in, text.data(), text.size()) != (ssize_t)text.size()) deadline = sent;
+    }
+
+    //drains the pipe, true once both command lines of the turn are in; now is when epoll
+    //reported the data, so the other events of the batch do not count as the bot's time
+    bool Read(Clock::time_point now)
+    {
+        char chunk[4096];
+        for(;;)
+        {
+            ssize_t n = read(out, chunk, sizeof(chunk));
+            if(n > 0)
+            {
+                buffer.append(chunk, n);
+                continue;
+            }
+            if(n == 0 || (errno != EAGAIN && errno != EINTR)) outcome = OutcomeInvalid;
+            if(n == 0 || errno != EINTR) break;
+        }
+
+        size_t start = 0, end;
+        while(waiting && outcome == OutcomeOk && (end = buffer.find('\n', start)) != string::npos)
+        {
+            if(!ParseAction(buffer.substr(start, end - start), actions[lines])) outcome = OutcomeInvalid;
+            start = end + 1;
+            if(++lines == K_PLAYERCOUNT)
+            {
+                waiting = false;
+                answered = max(now, sent); //a turn sent earlier in the same batch
+            }
+        }
+        buffer.erase(0, start);
+        if(buffer.size() > K_RUNNER_MAX_LINE) outcome = OutcomeInvalid;
+        return outcome == OutcomeOk && !waiting;
+    }
+};
+
+struct Match
+{
+    int index;
+    Race race;
+    BotProcess bots[K_PLAYERCOUNT]; //by player
+    bool done = false;
+
+    //which of the two bots plays player, sides alternate between races
+    int BotOf(int player) const { return (player + index) % K_PLAYERCOUNT; }
+};
+
+struct BotStats
+{
+    int wins = 0;
+    int losses = 0;
+    int draws = 0;
+    int timeouts = 0;
+    int invalid = 0;
+    vector<float> firstMs; //response to the first turn, which has its own limit
+    vector<float> turnMs;
+
+    void Merge(const BotStats& other)
+    {
+        wins += other.wins;
+        losses += other.losses;
+        draws += other.draws;
+        timeouts += other.timeouts;
+        invalid += other.invalid;
+        firstMs.insert(firstMs.end(), other.firstMs.begin(), other.firstMs.end());
+        turnMs.insert(turnMs.end(), other.turnMs.begin(), other.turnMs.end());
+    }
+};
+
+struct RunnerConfig
+{
+    const char* bots[K_PLAYERCOUNT];
+    int matches = K_RUNNER_MATCHES;
+    int workers = (int)max(1u, thread::hardware_concurrency());
+    int parallel = workers * K_RUNNER_RACES_PER_CORE;
+    float timeoutMs = K_RUNNER_TIMEOUT_MS;
+    float firstTimeoutMs = K_RUNNER_FIRST_TIMEOUT_MS;
+    uint32_t seed = 1;
+};
+
+// Plays its share of the races: keeps up to capacity of them in flight, takes the next race
+// index from the shared counter whenever one ends.
+struct Worker
+{
+    const RunnerConfig& config;
+    atomic<int>& next;
+    int capacity;
+    int epoll = -1;
+    vector<unique_ptr<Match>> live;
+    BotStats stats[K_PLAYERCOUNT]; //by bot
+    long turns = 0;
+
+    Worker(const RunnerConfig& runnerConfig, atomic<int>& nextMatch, int maxLive) : config(runnerConfig), next(nextMatch), capacity(maxLive) {}
+
+    void SendTurn(Match& match)
+    {
+        string header;
+        if(match.race.turn == 0)
+        {
+            const Track& track = match.race.track;
+            header = to_string(track.lapCount) + "\n" + to_string(track.checkpointCount) + "\n";
+            for(int c=0; c < track.checkpointCount; ++c)
+            {
+                header += to_string((int)track.checkpoints[c].x) + " " + to_string((int)track.checkpoints[c].y) + "\n";
+            }
+        }
+
+        for(int p=0; p < K_PLAYERCOUNT; ++p)
+        {
+            PodState view[K_TOTAL_SHIPCOUNT];
+            match.race.View(p, view);
+            string text = header;
+            char line[96];
+            for(const PodState& pod : view)
+            {
+                snprintf(line, sizeof(line), "%d %d %d %d %d %d\n", (int)pod.pos.x, (int)pod.pos.y, (int)pod.velocity.x, (int)pod.velocity.y,
+                    (int)lroundf(pod.angle), pod.nextCheckpointIdx);
+                text += line;
+            }
+            match.bots[p].Send(text, (match.race.turn == 0) ? config.firstTimeoutMs : config.timeoutMs);
+        }
+    }
+
+    void Start(int index)
+    {
+        auto match = make_unique<Match>();
+        match->index = index;
+        mt19937 rng(config.seed + (uint32_t)index);
+        match->race.Start(RandomTrack(rng));
+
+        bool spawned = true;
+        for(int p=0; p < K_PLAYERCOUNT; ++p)
+        {
+            BotProcess& bot = match->bots[p];
+            bot.match = match.get();
+            bot.player = p;
+            if(!bot.Spawn(config.bots[match->BotOf(p)], epoll))
+            {
+                fprintf(stderr, "cannot run %s\n", config.bots[match->BotOf(p)]);
+                spawned = false;
+            }
+        }
+        live.push_back(std::move(match));
+        if(spawned) SendTurn(*live.back());
+        else Finish(*live.back());
+    }
+
+    //ends the race on the race's result, or against every bot that failed this turn
+    void Finish(Match& match)
+    {
+        bool failed[K_PLAYERCOUNT];
+        int failures = 0;
+        for(int p=0; p < K_PLAYERCOUNT; ++p)
+        {
+            const BotProcess& bot = match.bots[p];
+            failed[p] = bot.outcome != OutcomeOk || bot.pid < 0;
+            failures += failed[p];
+            stats[match.BotOf(p)].timeouts += bot.outcome == OutcomeTimeout;
+            stats[match.BotOf(p)].invalid += bot.outcome == OutcomeInvalid;
+        }
+
+        int winner = match.race.winner;
+        if(failures > 0) winner = (failures == K_PLAYERCOUNT) ? K_PLAYERCOUNT : (failed[0] ? 1 : 0);
+        for(int p=0; p < K_PLAYERCOUNT; ++p)
+        {
+            BotStats& s = stats[match.BotOf(p)];
+            if(winner == K_PLAYERCOUNT) s.draws++;
+            else if(winner == p) s.wins++;
+            else s.losses++;
+            match.bots[p].Stop(epoll);
+        }
+        match.done = true;
+    }
+
+    //both bots answered: step the race and send the next turn
+    void Advance(Match& match)
+    {
+        PodAction actions[K_TOTAL_SHIPCOUNT];
+        for(int p=0; p < K_PLAYERCOUNT; ++p)
+        {
+            BotProcess& bot = match.bots[p];
+            std::copy(bot.actions, bot.actions + K_PLAYERCOUNT, actions + p * K_PLAYERCOUNT);
+            float ms = (float)Ms(bot.answered - bot.sent);
+            if(match.race.turn == 0) stats[match.BotOf(p)].firstMs.push_back(ms);
+            else stats[match.BotOf(p)].turnMs.push_back(ms);
+        }
+
+        match.race.Step(actions);
+        turns++;
+        if(match.race.Finished()) Finish(match);
+        else SendTurn(match);
+    }
+
+    void Run()
+    {
+        epoll = epoll_create1(EPOLL_CLOEXEC);
+        epoll_event events[K_RUNNER_EVENTS];
+        for(;;)
+        {
+            while((int)live.size() < capacity)
+            {
+                int index = next++;
+                if(index >= config.matches) break;
+                Start(index);
+            }
+            live.erase(remove_if(live.begin(), live.end(), [](const unique_ptr<Match>& m) { return m->done; }), live.end());
+            if(live.empty()) break;
+
+            //sleep until a bot writes or the earliest deadline passes
+            Clock::time_point wake = Clock::time_point::max();
+            for(const auto& match : live)
+            {
+                for(const BotProcess& bot : match->bots) if(bot.waiting) wake = min(wake, bot.deadline);
+            }
+            int timeout = (wake == Clock::time_point::max()) ? -1 : (int)max(0.0, ceil(Ms(wake - Clock::now())));
+            int count = epoll_wait(epoll, events, K_RUNNER_EVENTS, timeout);
+            Clock::time_point ready = Clock::now();
+
+            //a bot that answered early does not have to wait for its opponent's event
+            for(int e=0; e < count; ++e)
+            {
+                BotProcess& bot = *(BotProcess*)events[e].data.ptr;
+                Match& match = *bot.match;
+                if(match.done) continue;
+                bot.Read(ready);
+                if(bot.outcome != OutcomeOk) Finish(match);
+                else if(!match.bots[0].waiting && !match.bots[1].waiting) Advance(match);
+            }
+
+            Clock::time_point now = Clock::now();
+            for(const auto& match : live)
+            {
+                if(match->done) continue;
+                bool late = false;
+                for(BotProcess& bot : match->bots)
+                {
+                    if(!bot.waiting || now < bot.deadline) continue;
+                    bot.outcome = OutcomeTimeout;
+                    late = true;
+                }
+                if(late) Finish(*match);
+            }
+        }
+        close(epoll);
+    }
+};
+
+void PrintLatency(const char* label, vector<float>& ms)
+{
+    if(ms.empty()) return;
+    sort(ms.begin(), ms.end());
+    double sum = 0.0;
+    for(float m : ms) sum += m;
+    auto Percentile = [&](int p) { return ms[(ms.size() - 1) * p / 100]; };
+    printf("    %-6s %9zu %9.3f %9.3f %9.3f %9.3f\n", label, ms.size(), sum / ms.size(), Percentile(50), Percentile(99), ms.back());
+}
+
+int main(int argc, char** argv)
+{
+    RunnerConfig config;
+    int positional = 0;
+    for(int i=1; i < argc; ++i)
+    {
+        bool hasValue = i + 1 < argc;
+        if(hasValue && strcmp(argv[i], "--matches") == 0) config.matches = atoi(argv[++i]);
+        else if(hasValue && strcmp(argv[i], "--parallel") == 0) config.parallel = atoi(argv[++i]);
+        else if(hasValue && strcmp(argv[i], "--workers") == 0) config.workers = atoi(argv[++i]);
+        else if(hasValue && strcmp(argv[i], "--timeout") == 0) config.timeoutMs = (float)atof(argv[++i]);
+        else if(hasValue && strcmp(argv[i], "--first-timeout") == 0) config.firstTimeoutMs = (float)atof(argv[++i]);
+        else if(hasValue && strcmp(argv[i], "--seed") == 0) config.seed = (uint32_t)atoi(argv[++i]);
+        else if(positional < K_PLAYERCOUNT) config.bots[positional++] = argv[i];
+    }
+    if(positional < K_PLAYERCOUNT)
+    {
+        fprintf(stderr, "usage: runner [--matches N] [--parallel P] [--workers W] [--timeout ms] [--first-timeout ms] [--seed S] <botA> <botB>\n");
+        return 1;
+    }
+    config.workers = max(1, min(config.workers, config.parallel));
+
+    signal(SIGPIPE, SIG_IGN); //a dead bot's pipe shows up as a failed write instead
+
+    atomic<int> next{0};
+    vector<unique_ptr<Worker>> workers;
+    for(int w=0; w < config.workers; ++w)
+    {
+        int capacity = config.parallel / config.workers + (w < config.parallel % config.workers);
+        workers.push_back(make_unique<Worker>(config, next, capacity));
+    }
+
+    Clock::time_point start = Clock::now();
+    vector<thread> threads;
+    for(auto& worker : workers) threads.emplace_back([&worker]() { worker->Run(); });
+    for(thread& t : threads) t.join();
+    double seconds = Ms(Clock::now() - start) / 1000.0;
+
+    BotStats stats[K_PLAYERCOUNT];
+    long turns = 0;
+    for(auto& worker : workers)
+    {
+        for(int b=0; b < K_PLAYERCOUNT; ++b) stats[b].Merge(worker->stats[b]);
+        turns += worker->turns;
+    }
+
+    printf("%d races, %d in flight on %d workers: %.2fs, %.1f races/s, %.0f turns/s\n", config.matches, config.parallel, config.workers,
+        seconds, config.matches / seconds, turns / seconds);
+    for(int b=0; b < K_PLAYERCOUNT; ++b)
+    {
+        BotStats& s = stats[b];
+        printf("%s: %d wins, %d losses, %d draws, %d timeouts, %d invalid\n", config.bots[b], s.wins, s.losses, s.draws, s.timeouts, s.invalid);
+        if(!s.firstMs.empty()) printf("    %-6s %9s %9s %9s %9s %9s\n", "ms", "turns", "mean", "p50", "p99", "max");
+        PrintLatency("first", s.firstMs);
+        PrintLatency("turn", s.turnMs);
+    }
+    return 0;
+}
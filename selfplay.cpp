@@ -0,0 +1,361 @@
+// Self-play dataset generator, not a submission.
+// build: g++ -std=c++17 -O2 -pthread -o selfplay selfplay.cpp
+//
+// selfplay <out.bin> [races] [seed] [threads]   append races to the dataset
+// selfplay --inspect <file.bin>                 summarize a dataset
+//
+// Every race puts the gold bot against a random league bot (gold included), on a
+// random track, with sides drawn at random. Each pod of each turn becomes one row
+// holding its state, the action its bot chose and the race result.
+//
+// The file is a sequence of self-describing chunks, only ever appended to:
+//   ChunkHeader, columnCount x ColumnHeader, then one fixed-width column after another.
+// Chunks and columns start on 64 byte boundaries, so a reader can mmap the file and
+// use every column as a plain array. A crash can only leave a truncated last chunk:
+// readers stop at it, and the next run cuts it off before appending its own chunks.
+
+#include "race.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+constexpr char K_CHUNK_MAGIC[8] = {'C', 'S', 'B', 'C', 'H', 'N', 'K', '1'};
+constexpr int K_CHUNK_ROWS = 1 << 16;
+constexpr int K_CHUNK_ALIGN = 64;
+
+struct ChunkHeader
+{
+    char magic[8];
+    uint64_t chunkBytes; //whole chunk including headers and padding
+    uint32_t rowCount;
+    uint32_t columnCount;
+};
+
+enum ColumnType : uint32_t
+{
+    ColumnU8,
+    ColumnI8,
+    ColumnI32,
+    ColumnU32,
+    ColumnF32
+};
+
+struct ColumnHeader
+{
+    char name[24];
+    uint32_t type;
+    uint32_t width; //bytes per row
+    uint64_t offset; //from the start of the chunk
+};
+
+// One pod on one turn. Positions are as the pod's own bot saw them, before the turn's move.
+struct Row
+{
+    uint32_t race;
+    int32_t turn;
+    int32_t pod; //0-1 belong to the first player
+    int32_t bot; //PolicyKind driving this pod
+    float x, y, vx, vy, angle;
+    int32_t nextCheckpoint;
+    int32_t checkpointsPassed;
+    float checkpointX, checkpointY; //next checkpoint
+    float followingX, followingY;   //the one after it
+    float targetX, targetY;
+    float thrust;
+    uint8_t shield;
+    uint8_t boost;
+    int8_t result; //1 if this pod's player won, -1 if it lost, 0 for a draw
+    int32_t raceTurns;
+};
+
+struct ColumnSpec
+{
+    const char* name;
+    ColumnType type;
+    size_t offset;
+    size_t width;
+};
+
+#define ROW_COLUMN(field, type) {#field, type, offsetof(Row, field), sizeof(Row::field)}
+const ColumnSpec K_COLUMNS[] = {
+    ROW_COLUMN(race, ColumnU32),
+    ROW_COLUMN(turn, ColumnI32),
+    ROW_COLUMN(pod, ColumnI32),
+    ROW_COLUMN(bot, ColumnI32),
+    ROW_COLUMN(x, ColumnF32),
+    ROW_COLUMN(y, ColumnF32),
+    ROW_COLUMN(vx, ColumnF32),
+    ROW_COLUMN(vy, ColumnF32),
+    ROW_COLUMN(angle, ColumnF32),
+    ROW_COLUMN(nextCheckpoint, ColumnI32),
+    ROW_COLUMN(checkpointsPassed, ColumnI32),
+    ROW_COLUMN(checkpointX, ColumnF32),
+    ROW_COLUMN(checkpointY, ColumnF32),
+    ROW_COLUMN(followingX, ColumnF32),
+    ROW_COLUMN(followingY, ColumnF32),
+    ROW_COLUMN(targetX, ColumnF32),
+    ROW_COLUMN(targetY, ColumnF32),
+    ROW_COLUMN(thrust, ColumnF32),
+    ROW_COLUMN(shield, ColumnU8),
+    ROW_COLUMN(boost, ColumnU8),
+    ROW_COLUMN(result, ColumnI8),
+    ROW_COLUMN(raceTurns, ColumnI32),
+};
+#undef ROW_COLUMN
+constexpr int K_COLUMN_COUNT = sizeof(K_COLUMNS) / sizeof(K_COLUMNS[0]);
+
+size_t AlignUp(size_t bytes) { return (bytes + K_CHUNK_ALIGN - 1) / K_CHUNK_ALIGN * K_CHUNK_ALIGN; }
+
+//appends whole chunks to the dataset file, shared by all workers
+struct DatasetFile
+{
+    FILE* file;
+    mutex lock;
+
+    void Append(const vector<Row>& rows)
+    {
+        if(rows.empty()) return;
+
+        size_t offset = AlignUp(sizeof(ChunkHeader) + K_COLUMN_COUNT * sizeof(ColumnHeader));
+        vector<ColumnHeader> columns(K_COLUMN_COUNT);
+        for(int c=0; c < K_COLUMN_COUNT; ++c)
+        {
+            ColumnHeader& column = columns[c];
+            memset(&column, 0, sizeof(column));
+            strncpy(column.name, K_COLUMNS[c].name, sizeof(column.name) - 1);
+            column.type = K_COLUMNS[c].type;
+            column.width = (uint32_t)K_COLUMNS[c].width;
+            column.offset = offset;
+            offset = AlignUp(offset + rows.size() * column.width);
+        }
+
+        vector<uint8_t> chunk(offset, 0);
+        ChunkHeader header;
+        memcpy(header.magic, K_CHUNK_MAGIC, sizeof(header.magic));
+        header.chunkBytes = offset;
+        header.rowCount = (uint32_t)rows.size();
+        header.columnCount = K_COLUMN_COUNT;
+        memcpy(chunk.data(), &header, sizeof(header));
+        memcpy(chunk.data() + sizeof(header), columns.data(), columns.size() * sizeof(ColumnHeader));
+
+        for(int c=0; c < K_COLUMN_COUNT; ++c)
+        {
+            uint8_t* out = chunk.data() + columns[c].offset;
+            for(const Row& row : rows)
+            {
+                memcpy(out, (const uint8_t*)&row + K_COLUMNS[c].offset, K_COLUMNS[c].width);
+                out += K_COLUMNS[c].width;
+            }
+        }
+
+        lock_guard<mutex> guard(lock);
+        fwrite(chunk.data(), 1, chunk.size(), file);
+        fflush(file);
+    }
+};
+
+//plays race `index` and appends its rows, everything about it follows from seed and index
+void GenerateRace(uint32_t seed, uint32_t index, vector<Row>& rows)
+{
+    mt19937 rng(seed * 1000003u + index);
+    Track track = RandomTrack(rng);
+
+    Bot bots[K_PLAYERCOUNT] = {{PolicyGold}, {(PolicyKind)uniform_int_distribution<int>(0, PolicyKindCount - 1)(rng)}};
+    if(rng() & 1) swap(bots[0].kind, bots[1].kind);
+
+    size_t firstRow = rows.size();
+    int winner = PlayRace(track, bots[0], bots[1], [&](const Race& race, const PodAction* actions)
+    {
+        for(int i=0; i < K_TOTAL_SHIPCOUNT; ++i)
+        {
+            const PodState& pod = race.pods[i];
+            Vec2 checkpoint = track.checkpoints[pod.nextCheckpointIdx];
+            Vec2 following = track.checkpoints[(pod.nextCheckpointIdx+1)%track.checkpointCount];
+            const PodAction& action = actions[i];
+
+            Row row;
+            row.race = index;
+            row.turn = race.turn;
+            row.pod = i;
+            row.bot = bots[Race::Owner(i)].kind;
+            row.x = pod.pos.x; row.y = pod.pos.y;
+            row.vx = pod.velocity.x; row.vy = pod.velocity.y;
+            row.angle = pod.angle;
+            row.nextCheckpoint = pod.nextCheckpointIdx;
+            row.checkpointsPassed = pod.checkpointsPassedCount;
+            row.checkpointX = checkpoint.x; row.checkpointY = checkpoint.y;
+            row.followingX = following.x; row.followingY = following.y;
+            row.targetX = action.target.x; row.targetY = action.target.y;
+            row.thrust = action.thrust;
+            row.shield = action.shield;
+            row.boost = action.boost;
+            rows.push_back(row);
+        }
+    });
+
+    int raceTurns = (int)((rows.size() - firstRow) / K_TOTAL_SHIPCOUNT);
+    for(size_t r=firstRow; r < rows.size(); ++r)
+    {
+        int owner = Race::Owner(rows[r].pod);
+        rows[r].result = (winner == K_PLAYERCOUNT) ? 0 : (winner == owner ? 1 : -1);
+        rows[r].raceTurns = raceTurns;
+    }
+}
+
+//end of the last complete chunk, everything past it is what a crash left of the next one
+off_t CompleteBytes(int fd, off_t size)
+{
+    off_t pos = 0;
+    ChunkHeader header;
+    while(pread(fd, &header, sizeof(header), pos) == (ssize_t)sizeof(header))
+    {
+        if(memcmp(header.magic, K_CHUNK_MAGIC, sizeof(header.magic)) != 0) break;
+        if(header.chunkBytes < sizeof(header) || pos + (off_t)header.chunkBytes > size) break;
+        pos += (off_t)header.chunkBytes;
+    }
+    return pos;
+}
+
+int Generate(const char* path, uint32_t races, uint32_t seed, int threads)
+{
+    DatasetFile dataset;
+    int fd = open(path, O_RDWR | O_CREAT | O_APPEND, 0644);
+    struct stat info;
+    if(fd < 0 || fstat(fd, &info) != 0)
+    {
+        fprintf(stderr, "cannot open %s\n", path);
+        return 1;
+    }
+    off_t complete = CompleteBytes(fd, info.st_size);
+    if(complete < info.st_size)
+    {
+        fprintf(stderr, "dropping %lld bytes of a truncated chunk at offset %lld\n", (long long)(info.st_size - complete), (long long)complete);
+        if(ftruncate(fd, complete) != 0)
+        {
+            fprintf(stderr, "cannot truncate %s\n", path);
+            return 1;
+        }
+    }
+    dataset.file = fdopen(fd, "ab");
+
+    atomic<uint32_t> nextRace(0);
+    atomic<uint64_t> totalRows(0);
+    auto Worker = [&]()
+    {
+        vector<Row> rows;
+        rows.reserve(K_CHUNK_ROWS + K_MAX_RACE_TURNS * K_TOTAL_SHIPCOUNT);
+        for(uint32_t race = nextRace++; race < races; race = nextRace++)
+        {
+            GenerateRace(seed, race, rows);
+            if(rows.size() >= K_CHUNK_ROWS)
+            {
+                totalRows += rows.size();
+                dataset.Append(rows);
+                rows.clear();
+            }
+        }
+        totalRows += rows.size();
+        dataset.Append(rows);
+    };
+
+    auto start = chrono::steady_clock::now();
+    vector<thread> workers;
+    for(int i=0; i < threads; ++i) workers.emplace_back(Worker);
+    for(thread& worker : workers) worker.join();
+    fclose(dataset.file);
+
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    printf("%u races, %llu rows in %.1fs on %d threads (%.0f rows/s)\n", races, (unsigned long long)totalRows.load(), seconds, threads, totalRows / seconds);
+    return 0;
+}
+
+//walks the chunks of a mapped dataset and reports per bot results, reading columns in place
+int Inspect(const char* path)
+{
+    int fd = open(path, O_RDONLY);
+    struct stat info;
+    if(fd < 0 || fstat(fd, &info) != 0 || info.st_size == 0)
+    {
+        fprintf(stderr, "cannot read %s\n", path);
+        return 1;
+    }
+    size_t size = (size_t)info.st_size;
+    const uint8_t* base = (const uint8_t*)mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if(base == MAP_FAILED) return 1;
+
+    uint64_t chunks = 0, rows = 0;
+    uint64_t podTurns[PolicyKindCount] = {}, wins[PolicyKindCount] = {}, races[PolicyKindCount] = {};
+    size_t pos = 0;
+    while(pos + sizeof(ChunkHeader) <= size)
+    {
+        const ChunkHeader* header = (const ChunkHeader*)(base + pos);
+        if(memcmp(header->magic, K_CHUNK_MAGIC, sizeof(header->magic)) != 0 || pos + header->chunkBytes > size)
+        {
+            fprintf(stderr, "stopping at offset %zu: truncated or foreign chunk\n", pos);
+            break;
+        }
+
+        const ColumnHeader* columns = (const ColumnHeader*)(header + 1);
+        auto Column = [&](const char* name) -> const uint8_t*
+        {
+            for(uint32_t c=0; c < header->columnCount; ++c)
+            {
+                if(strcmp(columns[c].name, name) == 0) return base + pos + columns[c].offset;
+            }
+            return nullptr;
+        };
+        const int32_t* turn = (const int32_t*)Column("turn");
+        const int32_t* bot = (const int32_t*)Column("bot");
+        const int32_t* pod = (const int32_t*)Column("pod");
+        const int8_t* result = (const int8_t*)Column("result");
+
+        for(uint32_t r=0; r < header->rowCount; ++r)
+        {
+            podTurns[bot[r]]++;
+            if(turn[r] == 0 && pod[r] % K_PLAYERCOUNT == 0)
+            {
+                races[bot[r]]++;
+                wins[bot[r]] += (result[r] == 1);
+            }
+        }
+
+        chunks++;
+        rows += header->rowCount;
+        pos += header->chunkBytes;
+    }
+    munmap((void*)base, size);
+
+    printf("%llu chunks, %llu rows\n", (unsigned long long)chunks, (unsigned long long)rows);
+    for(int b=0; b < PolicyKindCount; ++b)
+    {
+        if(races[b] == 0) continue;
+        printf("  %-7s %8llu pod turns, %6llu races, win rate %.1f%%\n", K_POLICY_NAMES[b], (unsigned long long)podTurns[b], (unsigned long long)races[b], 100.0 * wins[b] / races[b]);
+    }
+    return 0;
+}
+
+int main(int argc, char** argv)
+{
+    if(argc >= 3 && strcmp(argv[1], "--inspect") == 0)
+    {
+        return Inspect(argv[2]);
+    }
+    if(argc < 2)
+    {
+        fprintf(stderr, "usage: %s <out.bin> [races] [seed] [threads] | --inspect <file.bin>\n", argv[0]);
+        return 1;
+    }
+
+    uint32_t races = (argc > 2) ? (uint32_t)atoi(argv[2]) : 1000;
+    uint32_t seed = (argc > 3) ? (uint32_t)atoi(argv[3]) : 1;
+    int threads = (argc > 4) ? atoi(argv[4]) : (int)max(1u, thread::hardware_concurrency());
+    return Generate(argv[1], races, seed, threads);
+}
@@ -0,0 +1,207 @@
+// Decoder for the telemetry stream of gold.cpp, not a submission.
+// build: g++ -std=c++17 -O2 -o telemetry telemetry.cpp
+//
+// telemetry <stream|-> [--csv]
+//
+// Reads binary records (-DGOLD_TELEMETRY=2) or NDJSON (-DGOLD_TELEMETRY=1), told apart by
+// the first byte, and prints one table per turn: stage timings, then a row per pod with
+// its state, command, shield, boost and replan reasons and where it was predicted to go. --csv
+// prints a single table with one row per pod and turn instead.
+
+#define GOLD_NO_MAIN
+#include "gold.cpp"
+
+#include <cstring>
+
+//start of the value following "key": within [from, to), nullptr if absent
+const char* FindKey(const char* from, const char* to, const char* key)
+{
+    char pattern[64];
+    snprintf(pattern, sizeof(pattern), "\"%s\":", key);
+    const char* found = strstr(from, pattern);
+    return (found && found < to) ? found + strlen(pattern) : nullptr;
+}
+
+float NumberAt(const char* from, const char* to, const char* key)
+{
+    const char* value = FindKey(from, to, key);
+    return value ? strtof(value, nullptr) : 0.0f;
+}
+
+//the n numbers of a flat array value, nested arrays are read in order
+void NumbersAt(const char* from, const char* to, const char* key, float* out, int n)
+{
+    const char* value = FindKey(from, to, key);
+    for(int i=0; i < n; ++i)
+    {
+        out[i] = 0.0f;
+        while(value && value < to && !(isdigit(*value) || *value == '-')) value++;
+        if(!value || value >= to) continue;
+        char* end;
+        out[i] = strtof(value, &end);
+        value = end;
+    }
+}
+
+//index of the string value of key within names, 0 when unknown
+template<int N>
+uint8_t NameAt(const char* from, const char* to, const char* key, const char* const (&names)[N])
+{
+    const char* value = FindKey(from, to, key);
+    for(int i=0; value && i < N; ++i)
+    {
+        size_t length = strlen(names[i]);
+        if(value[0] == '"' && strncmp(value + 1, names[i], length) == 0 && value[length + 1] == '"') return (uint8_t)i;
+    }
+    return 0;
+}
+
+bool ParseNdjson(const string& line, TelemetryTurn& t)
+{
+    const char* begin = line.c_str();
+    const char* end = begin + line.size();
+    if(!FindKey(begin, end, "turn")) return false;
+
+    t = {};
+    t.magic = K_TELEMETRY_MAGIC;
+    t.turn = (uint32_t)NumberAt(begin, end, "turn");
+    t.dropped = (uint32_t)NumberAt(begin, end, "dropped");
+    t.replanTurns = (uint32_t)NumberAt(begin, end, "replan_turns");
+    t.lazyTurns = (uint32_t)NumberAt(begin, end, "lazy_turns");
+    t.savedUs = NumberAt(begin, end, "saved_us");
+    for(int s=0; s < StageCount; ++s) t.stageUs[s] = NumberAt(begin, end, K_STAGE_NAMES[s]);
+
+    //pods are consecutive objects that each start with their role
+    const char* pod = FindKey(begin, end, "pods");
+    for(int i=0; i < K_TOTAL_SHIPCOUNT && pod; ++i)
+    {
+        const char* from = strstr(pod, "{\"role\"");
+        if(!from) return false;
+        const char* next = strstr(from + 1, "{\"role\"");
+        const char* to = next ? next : end;
+
+        TelemetryPod& p = t.pods[i];
+        p.role = NameAt(from, to, "role", K_ROLE_NAMES);
+        NumbersAt(from, to, "pos", p.pos, 2);
+        NumbersAt(from, to, "vel", p.velocity, 2);
+        p.angle = NumberAt(from, to, "angle");
+        p.nextCheckpointIdx = (int32_t)NumberAt(from, to, "cp");
+        p.checkpointsPassedCount = (int32_t)NumberAt(from, to, "passed");
+        NumbersAt(from, to, "target", p.target, 2);
+        p.thrust = NumberAt(from, to, "thrust");
+        p.shield = (uint8_t)NumberAt(from, to, "shield");
+        p.shieldReason = NameAt(from, to, "shield_reason", K_SHIELD_REASON_NAMES);
+        p.shieldGain = NumberAt(from, to, "shield_gain");
+        p.boost = (uint8_t)NumberAt(from, to, "boost");
+        p.boostReason = NameAt(from, to, "boost_reason", K_BOOST_REASON_NAMES);
+        p.replanReason = NameAt(from, to, "replan_reason", K_REPLAN_REASON_NAMES);
+        NumbersAt(from, to, "predicted", &p.predicted[0][0], K_TELEMETRY_PREDICT_TURNS * 2);
+        pod = to;
+    }
+    return true;
+}
+
+void PrintTable(const TelemetryTurn& t)
+{
+    printf("turn %u", t.turn);
+    for(int s=0; s < StageCount; ++s) printf("  %s %.1fus", K_STAGE_NAMES[s], t.stageUs[s]);
+    if(t.replanTurns + t.lazyTurns) printf("  replans %u/%u saved %.0fus", t.replanTurns, t.replanTurns + t.lazyTurns, t.savedUs);
+    if(t.dropped) printf("  (%u dropped so far)", t.dropped);
+    printf("\n  %-3s %-6s %11s %11s %6s %6s %11s %6s %-22s %-15s %-10s %11s\n",
+        "pod", "role", "pos", "vel", "angle", "cp", "target", "thrust", "shield", "boost", "replan", "predicted");
+    for(int i=0; i < K_TOTAL_SHIPCOUNT; ++i)
+    {
+        const TelemetryPod& p = t.pods[i];
+        char shield[32], boost[24], cp[16];
+        snprintf(shield, sizeof(shield), "%s %s %.0f", p.shield ? "yes" : "no", K_SHIELD_REASON_NAMES[p.shieldReason], p.shieldGain);
+        snprintf(boost, sizeof(boost), "%s %s", p.boost ? "yes" : "no", K_BOOST_REASON_NAMES[p.boostReason]);
+        snprintf(cp, sizeof(cp), "%d/%d", p.nextCheckpointIdx, p.checkpointsPassedCount);
+        const float* last = p.predicted[K_TELEMETRY_PREDICT_TURNS - 1];
+        bool enemy = p.role == K_ROLE_ENEMY;
+        printf("  %-3d %-6s %5.0f,%5.0f %5.0f,%5.0f %6.1f %6s %5.0f,%5.0f %6.0f %-22s %-15s %-10s %5.0f,%5.0f\n",
+            i, K_ROLE_NAMES[p.role], p.pos[0], p.pos[1], p.velocity[0], p.velocity[1], p.angle, cp,
+            p.target[0], p.target[1], p.thrust, enemy ? "" : shield, enemy ? "" : boost, enemy ? "" : K_REPLAN_REASON_NAMES[p.replanReason], last[0], last[1]);
+    }
+}
+
+void PrintCsvHeader()
+{
+    printf("turn,pod,role,x,y,vx,vy,angle,cp,passed,target_x,target_y,thrust,shield,shield_reason,shield_gain,boost,boost_reason,replan_reason");
+    for(int k=1; k <= K_TELEMETRY_PREDICT_TURNS; ++k) printf(",predicted_x_%d,predicted_y_%d", k, k);
+    for(int s=0; s < StageCount; ++s) printf(",%s_us", K_STAGE_NAMES[s]);
+    printf("\n");
+}
+
+void PrintCsv(const TelemetryTurn& t)
+{
+    for(int i=0; i < K_TOTAL_SHIPCOUNT; ++i)
+    {
+        const TelemetryPod& p = t.pods[i];
+        printf("%u,%d,%s,%.0f,%.0f,%.0f,%.0f,%.1f,%d,%d,%.0f,%.0f,%.0f", t.turn, i, K_ROLE_NAMES[p.role],
+            p.pos[0], p.pos[1], p.velocity[0], p.velocity[1], p.angle, p.nextCheckpointIdx, p.checkpointsPassedCount,
+            p.target[0], p.target[1], p.thrust);
+        //enemies have no shield, boost or replan decisions, their fields stay empty
+        if(p.role == K_ROLE_ENEMY) printf(",,,,,,");
+        else printf(",%d,%s,%.1f,%d,%s,%s", p.shield, K_SHIELD_REASON_NAMES[p.shieldReason], p.shieldGain, p.boost, K_BOOST_REASON_NAMES[p.boostReason], K_REPLAN_REASON_NAMES[p.replanReason]);
+        for(int k=0; k < K_TELEMETRY_PREDICT_TURNS; ++k) printf(",%.0f,%.0f", p.predicted[k][0], p.predicted[k][1]);
+        for(int s=0; s < StageCount; ++s) printf(",%.1f", t.stageUs[s]);
+        printf("\n");
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if(argc < 2)
+    {
+        fprintf(stderr, "usage: telemetry <stream|-> [--csv]\n");
+        return 1;
+    }
+    bool csv = argc > 2 && strcmp(argv[2], "--csv") == 0;
+    FILE* file = (strcmp(argv[1], "-") == 0) ? stdin : fopen(argv[1], "rb");
+    if(!file)
+    {
+        fprintf(stderr, "cannot read %s\n", argv[1]);
+        return 1;
+    }
+
+    auto Print = [&](const TelemetryTurn& t) { if(csv) PrintCsv(t); else PrintTable(t); };
+    if(csv) PrintCsvHeader();
+
+    int first = fgetc(file);
+    ungetc(first, file);
+    long records = 0;
+    if(first == '{')
+    {
+        string line;
+        char buffer[4096];
+        while(fgets(buffer, sizeof(buffer), file))
+        {
+            line += buffer;
+            if(line.back() != '\n') continue;
+            TelemetryTurn t;
+            if(ParseNdjson(line, t))
+            {
+                Print(t);
+                records++;
+            }
+            line.clear();
+        }
+    }
+    else
+    {
+        TelemetryTurn t;
+        while(fread(&t, sizeof(t), 1, file) == 1)
+        {
+            if(t.magic != K_TELEMETRY_MAGIC)
+            {
+                fprintf(stderr, "bad record magic after %ld records\n", records);
+                return 1;
+            }
+            Print(t);
+            records++;
+        }
+    }
+
+    if(!csv) printf("%ld turns\n", records);
+    return 0;
+}
@@ -0,0 +1,211 @@
+// Solo time trial over a fixed track corpus, not a submission.
+// build: g++ -std=c++17 -O2 -o timetrial timetrial.cpp
+//
+// timetrial --generate <tracks.txt> [perClass] [seed]   write a corpus, perClass tracks per checkpoint count
+// timetrial <tracks.txt> [bot ...]                      race every bot (all by default) over the corpus
+//
+// The first pod of the bot races alone: the other three are parked far off the map,
+// so the turns it needs to finish measure racing speed and nothing else. A pod that
+// misses a checkpoint for K_TIMEOUT_TURNS or runs out of K_MAX_RACE_TURNS does not
+// finish and counts as K_MAX_RACE_TURNS. The score of a bot is its mean over the corpus.
+//
+// Corpus format, one track per line: lapCount checkpointCount x0 y0 x1 y1 ...
+
+#include "race.h"
+
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+constexpr int K_TRIAL_PER_CLASS = 30;
+constexpr int K_CORNER_CLASSES = 3;
+const char* K_CORNER_CLASS_NAMES[K_CORNER_CLASSES] = {"flowing", "mixed", "hairpin"};
+
+bool WriteCorpus(const char* path, int perClass, uint32_t seed)
+{
+    ofstream file(path);
+    if(!file) return false;
+
+    mt19937 rng(seed);
+    for(int count=K_MIN_CHECKPOINTS; count <= K_MAX_CHECKPOINTS; ++count)
+    {
+        for(int i=0; i < perClass; ++i)
+        {
+            Track track = RandomTrack(rng, count);
+            file << track.lapCount << " " << track.checkpointCount;
+            for(int c=0; c < track.checkpointCount; ++c)
+            {
+                file << " " << (int)track.checkpoints[c].x << " " << (int)track.checkpoints[c].y;
+            }
+            file << "\n";
+        }
+    }
+    return true;
+}
+
+vector<Track> ReadCorpus(const char* path)
+{
+    vector<Track> tracks;
+    ifstream file(path);
+    string line;
+    while(getline(file, line))
+    {
+        istringstream in(line);
+        Track track;
+        if(!(in >> track.lapCount >> track.checkpointCount)) continue;
+        if(track.checkpointCount < K_MIN_CHECKPOINTS || track.checkpointCount > K_MAX_CHECKPOINTS) continue;
+        for(int c=0; c < track.checkpointCount; ++c)
+        {
+            int x, y;
+            in >> x >> y;
+            track.checkpoints[c] = {(float)x, (float)y};
+        }
+        if(in) tracks.push_back(track);
+    }
+    return tracks;
+}
+
+// Mean turn between the legs joining checkpoint centers, not the racing line itself. A lap
+// turns at least 360 degrees, so the mean starts at 360 / checkpointCount and random tracks
+// mostly land between 90 and 150: under 110 flows, from 135 on is a hairpin. Triangles are
+// always 120, mixed, and two checkpoint tracks 180, hairpins.
+int CornerClass(const Track& track)
+{
+    float total = 0.0f;
+    for(int i=0; i < track.checkpointCount; ++i)
+    {
+        Vec2 in = track.checkpoints[i] - track.checkpoints[(i + track.checkpointCount - 1) % track.checkpointCount];
+        Vec2 out = track.checkpoints[(i + 1) % track.checkpointCount] - track.checkpoints[i];
+        total += abs(AngleDiff(in.ToAngle() * K_RAD_TO_DEG, out.ToAngle() * K_RAD_TO_DEG));
+    }
+    float mean = total / track.checkpointCount;
+    return (mean < 110.0f) ? 0 : (mean < 135.0f) ? 1 : 2;
+}
+
+//turns the bot's first pod needs to finish alone, K_MAX_RACE_TURNS if it does not
+int TimeTrial(const Track& track, Bot& bot)
+{
+    Race race;
+    race.Start(track);
+    bot.Start(track);
+
+    race.pods[0].pos = track.checkpoints[0];
+    for(int i=1; i < K_TOTAL_SHIPCOUNT; ++i)
+    {
+        race.pods[i].pos = {-100000.0f * i, -100000.0f};
+    }
+
+    int finish = track.lapCount * track.checkpointCount;
+    int timeout = K_TIMEOUT_TURNS;
+    while(race.turn < K_MAX_RACE_TURNS && timeout > 0)
+    {
+        PodAction actions[K_TOTAL_SHIPCOUNT];
+        bot.Decide(race, 0, actions);
+
+        int passed = race.pods[0].checkpointsPassedCount;
+        SimulateTurn(race.pods, actions, 1, track.checkpoints, track.checkpointCount);
+        race.turn++;
+
+        if(race.pods[0].checkpointsPassedCount >= finish) return race.turn;
+        timeout = (race.pods[0].checkpointsPassedCount != passed) ? K_TIMEOUT_TURNS : timeout - 1;
+    }
+    return K_MAX_RACE_TURNS;
+}
+
+struct TrialStats
+{
+    vector<int> turns;
+
+    void Add(int t) { turns.push_back(t); }
+
+    double Mean() const
+    {
+        double sum = 0.0;
+        for(int t : turns) sum += t;
+        return turns.empty() ? 0.0 : sum / turns.size();
+    }
+
+    void Print(const char* label)
+    {
+        if(turns.empty()) return;
+        sort(turns.begin(), turns.end());
+        auto Percentile = [&](int p) { return turns[(turns.size() - 1) * p / 100]; };
+        int dnf = (int)count(turns.begin(), turns.end(), K_MAX_RACE_TURNS);
+        printf("  %-12s %6zu %5d %8.1f %5d %5d %5d %5d\n", label, turns.size(), dnf, Mean(), turns.front(), Percentile(10), Percentile(50), Percentile(90));
+    }
+};
+
+void RunTrials(const vector<Track>& tracks, PolicyKind kind)
+{
+    TrialStats all, byCount[K_MAX_CHECKPOINTS + 1], byCorner[K_CORNER_CLASSES];
+    Bot bot{kind};
+    for(const Track& track : tracks)
+    {
+        int turns = TimeTrial(track, bot);
+        all.Add(turns);
+        byCount[track.checkpointCount].Add(turns);
+        byCorner[CornerClass(track)].Add(turns);
+    }
+
+    printf("%s: %.2f turns per race\n", K_POLICY_NAMES[kind], all.Mean());
+    printf("  %-12s %6s %5s %8s %5s %5s %5s %5s\n", "class", "tracks", "dnf", "mean", "min", "p10", "p50", "p90");
+    for(int count=K_MIN_CHECKPOINTS; count <= K_MAX_CHECKPOINTS; ++count)
+    {
+        byCount[count].Print((to_string(count) + " cps").c_str());
+    }
+    for(int c=0; c < K_CORNER_CLASSES; ++c)
+    {
+        byCorner[c].Print(K_CORNER_CLASS_NAMES[c]);
+    }
+    all.Print("all");
+}
+
+int Usage()
+{
+    fprintf(stderr, "usage: timetrial --generate <tracks.txt> [perClass] [seed]\n       timetrial <tracks.txt> [bot ...]\n");
+    return 1;
+}
+
+int main(int argc, char** argv)
+{
+    if(argc >= 3 && strcmp(argv[1], "--generate") == 0)
+    {
+        int perClass = (argc > 3) ? atoi(argv[3]) : K_TRIAL_PER_CLASS;
+        uint32_t seed = (argc > 4) ? (uint32_t)atoi(argv[4]) : 2024;
+        if(!WriteCorpus(argv[2], perClass, seed))
+        {
+            fprintf(stderr, "cannot write %s\n", argv[2]);
+            return 1;
+        }
+        return 0;
+    }
+
+    if(argc < 2) return Usage();
+
+    vector<Track> tracks = ReadCorpus(argv[1]);
+    if(tracks.empty())
+    {
+        fprintf(stderr, "no tracks in %s\n", argv[1]);
+        return 1;
+    }
+
+    vector<PolicyKind> kinds;
+    for(int i=2; i < argc; ++i)
+    {
+        int k = 0;
+        while(k < PolicyKindCount && strcmp(argv[i], K_POLICY_NAMES[k]) != 0) ++k;
+        if(k == PolicyKindCount)
+        {
+            fprintf(stderr, "unknown bot %s\n", argv[i]);
+            return Usage();
+        }
+        kinds.push_back((PolicyKind)k);
+    }
+    if(argc == 2)
+    {
+        for(int k=0; k < PolicyKindCount; ++k) kinds.push_back((PolicyKind)k);
+    }
+
+    for(PolicyKind kind : kinds) RunTrials(tracks, kind);
+    return 0;
+}